@@ -413,7 +413,7 @@ void Bias::updateForceCorrelationGrid(gmx::ArrayRef<const double> probWeightNeig
         return;
     }
 
-    const std::vector<int>& neighbor = grid_.point(state_.coordState().gridpointIndex()).neighbor;
+    const std::vector<int>& neighbor = grid_.neighbors(state_.coordState().gridpointIndex());
 
     gmx::ArrayRef<double> forceFromNeighbor = tempForce_;
     for (size_t n = 0; n < neighbor.size(); n++)
@@ -842,16 +842,20 @@ BiasGrid::BiasGrid(const std::vector<DimParams>& dimParams, const AwhDimParams*
     /* Set their values */
     initPoints();
 
-    /* Keep a neighbor list for each point.
-     * Note: could also generate neighbor list only when needed
-     * instead of storing them for each point.
-     */
-    for (size_t m = 0; m < point_.size(); m++)
-    {
-        std::vector<int>* neighbor = &point_[m].neighbor;
+    /* The neighbor lists are generated when needed */
+    neighbors_.resize(numPoints);
+}
 
-        setNeighborsOfGridPoint(m, *this, neighbor);
-    }
+void BiasGrid::generateNeighbors(size_t pointIndex, std::vector<int>* neighbors) const
+{
+    neighbors->clear();
+    setNeighborsOfGridPoint(pointIndex, *this, neighbors);
+}
+
+size_t BiasGrid::numPointsWithStoredNeighbors() const
+{
+    return std::count_if(neighbors_.begin(), neighbors_.end(),
+                         [](const std::vector<int>& pointNeighbors) { return !pointNeighbors.empty(); });
 }
 
 void mapGridToDataGrid(std::vector<int>*    gridpointToDatapoint,
@@ -155,14 +155,12 @@ private:
  * \brief A point in the grid.
  *
  * A grid point has a coordinate value and a coordinate index of the same dimensionality as the
- * grid. It knows the linear indices of its neighboring point (which are useful only when handed up
- * to the grid).
+ * grid. The linear indices of its neighboring points are provided by the grid.
  */
 struct GridPoint
 {
-    awh_dvec         coordValue; /**< Multidimensional coordinate value of this point */
-    awh_ivec         index;      /**< Multidimensional point indices */
-    std::vector<int> neighbor;   /**< Linear point indices of the neighboring points */
+    awh_dvec coordValue; /**< Multidimensional coordinate value of this point */
+    awh_ivec index;      /**< Multidimensional point indices */
 };
 
 /*! \internal
@@ -171,6 +169,11 @@ struct GridPoint
  * The grid discretizes a multidimensional space with some given resolution.
  * Each dimension is represented by an axis which sets the spatial extent,
  * point spacing and periodicity of the grid in that direction.
+ *
+ * With multiple dimensions, the neighbor lists of all points would take
+ * far more memory than the points themselves. Therefore neighbor lists
+ * are only stored for points whose neighbors are requested, which are the
+ * points in the sampled region.
  */
 class BiasGrid
 {
@@ -211,6 +214,48 @@ public:
      */
     const GridPoint& point(size_t pointIndex) const { return point_[pointIndex]; }
 
+    /*! \brief Returns the linear point indices of the neighbors of a point.
+     *
+     * The neighbor list is generated on first use and stored.
+     * For sweeps over all points, use neighborsWithoutStoring() instead.
+     * Note that this method is not thread safe.
+     *
+     * \param[in] pointIndex  Index of the point.
+     * \returns a constant reference to the neighbor list.
+     */
+    const std::vector<int>& neighbors(size_t pointIndex) const
+    {
+        std::vector<int>& pointNeighbors = neighbors_[pointIndex];
+        if (pointNeighbors.empty())
+        {
+            generateNeighbors(pointIndex, &pointNeighbors);
+        }
+        return pointNeighbors;
+    }
+
+    /*! \brief Returns the linear point indices of the neighbors of a point without storing them.
+     *
+     * Returns the stored neighbor list when present, otherwise the list
+     * is generated in \p buffer. Use this for sweeps over all points.
+     *
+     * \param[in]     pointIndex  Index of the point.
+     * \param[in,out] buffer      Buffer for generating the neighbor list.
+     * \returns a constant reference to the neighbor list.
+     */
+    const std::vector<int>& neighborsWithoutStoring(size_t pointIndex, std::vector<int>* buffer) const
+    {
+        if (!neighbors_[pointIndex].empty())
+        {
+            return neighbors_[pointIndex];
+        }
+        generateNeighbors(pointIndex, buffer);
+        return *buffer;
+    }
+
+    /*! \brief Returns the number of points with a stored neighbor list.
+     */
+    size_t numPointsWithStoredNeighbors() const;
+
     /*! \brief Returns the dimensionality of the grid.
      *
      * \returns the dimensionality of the grid.
@@ -267,8 +312,13 @@ public:
     int numFepLambdaStates() const;
 
 private:
+    //! Generates the neighbor list of a point in \p neighbors
+    void generateNeighbors(size_t pointIndex, std::vector<int>* neighbors) const;
+
     std::vector<GridPoint> point_; /**< Points on the grid */
     std::vector<GridAxis>  axis_;  /**< Axes, one for each dimension. */
+    //! Neighbor lists, empty for points whose neighbors have not been requested
+    mutable std::vector<std::vector<int>> neighbors_;
 };
 
 /*! \endcond */
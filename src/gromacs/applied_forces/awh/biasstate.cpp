@@ -59,6 +59,7 @@
 #include "gromacs/fileio/xvgr.h"
 #include "gromacs/gmxlib/network.h"
 #include "gromacs/math/utilities.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
 #include "gromacs/mdrunutility/multisim.h"
 #include "gromacs/mdtypes/awh_history.h"
 #include "gromacs/mdtypes/awh_params.h"
@@ -138,46 +139,22 @@ void sumOverSimulations(gmx::ArrayRef<T> arrayRef, const t_commrec* commRecord,
 }
 
 /*! \brief
- * Sum PMF over multiple simulations, when requested.
+ * Returns the number of OpenMP threads to use for a loop over grid points.
  *
- * \param[in,out] pointState         The state of the points in the bias.
- * \param[in]     numSharedUpdate    The number of biases sharing the histogram.
- * \param[in]     commRecord         Struct for intra-simulation communication.
- * \param[in]     multiSimComm       Struct for multi-simulation communication.
+ * \param[in] numPoints  The number of points in the loop.
+ * \returns the number of threads, 1 for small loops.
  */
-void sumPmf(gmx::ArrayRef<PointState> pointState,
-            int                       numSharedUpdate,
-            const t_commrec*          commRecord,
-            const gmx_multisim_t*     multiSimComm)
+int numThreadsForPointLoop(size_t numPoints)
 {
-    if (numSharedUpdate == 1)
-    {
-        return;
-    }
-    GMX_ASSERT(multiSimComm != nullptr && numSharedUpdate % multiSimComm->numSimulations_ == 0,
-               "numSharedUpdate should be a multiple of multiSimComm->numSimulations_");
-    GMX_ASSERT(numSharedUpdate == multiSimComm->numSimulations_,
-               "Sharing within a simulation is not implemented (yet)");
-
-    std::vector<double> buffer(pointState.size());
-
-    /* Need to temporarily exponentiate the log weights to sum over simulations */
-    for (size_t i = 0; i < buffer.size(); i++)
-    {
-        buffer[i] = pointState[i].inTargetRegion() ? std::exp(-pointState[i].logPmfSum()) : 0;
-    }
+    /* Updating a point costs a few exponentials at most, so with fewer
+     * points per thread the OpenMP overhead would dominate.
+     */
+    constexpr size_t c_minNumPointsPerThread = 1000;
 
-    sumOverSimulations(gmx::ArrayRef<double>(buffer), commRecord, multiSimComm);
+    const size_t maxNumThreads = std::max(1, gmx_omp_nthreads_get(emntDefault));
 
-    /* Take log again to get (non-normalized) PMF */
-    double normFac = 1.0 / numSharedUpdate;
-    for (gmx::index i = 0; i < pointState.ssize(); i++)
-    {
-        if (pointState[i].inTargetRegion())
-        {
-            pointState[i].setLogPmfSum(-std::log(buffer[i] * normFac));
-        }
-    }
+    return static_cast<int>(
+            std::clamp(numPoints / c_minNumPointsPerThread, static_cast<size_t>(1), maxNumThreads));
 }
 
 /*! \brief
@@ -308,11 +285,12 @@ void BiasState::calcConvolvedPmf(const std::vector<DimParams>& dimParams,
     std::vector<float> pmf(numPoints);
     getPmf(pmf);
 
+    std::vector<int> neighborBuffer;
     for (size_t m = 0; m < numPoints; m++)
     {
         double           freeEnergyWeights = 0;
         const GridPoint& point             = grid.point(m);
-        for (auto& neighbor : point.neighbor)
+        for (auto& neighbor : grid.neighborsWithoutStoring(m, &neighborBuffer))
         {
             /* Do not convolve the bias along a lambda axis - only use the pmf from the current point */
             if (!pointsHaveDifferentLambda(grid, m, neighbor))
@@ -355,18 +333,28 @@ void updateTargetDistribution(gmx::ArrayRef<PointState> pointState, const BiasPa
         freeEnergyCutoff = freeEnergyMinimumValue(pointState) + params.freeEnergyCutoffInKT;
     }
 
+    const int numThreads = numThreadsForPointLoop(pointState.size());
+
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (gmx::index m = 0; m < pointState.ssize(); m++)
+    {
+        pointState[m].updateTargetWeight(params, freeEnergyCutoff);
+    }
+
+    /* Sum serially, so the result does not depend on the number of threads */
     double sumTarget = 0;
-    for (PointState& ps : pointState)
+    for (const PointState& ps : pointState)
     {
-        sumTarget += ps.updateTargetWeight(params, freeEnergyCutoff);
+        sumTarget += ps.target();
     }
     GMX_RELEASE_ASSERT(sumTarget > 0, "We should have a non-zero distribution");
 
     /* Normalize to 1 */
     double invSum = 1.0 / sumTarget;
-    for (PointState& ps : pointState)
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (gmx::index m = 0; m < pointState.ssize(); m++)
     {
-        ps.scaleTarget(invSum);
+        pointState[m].scaleTarget(invSum);
     }
 }
 
@@ -423,16 +411,17 @@ int BiasState::warnForHistogramAnomalies(const BiasGrid& grid, int biasIndex, do
     double invNormWeight = 1.0 / sumWeights;
 
     /* Check all points for warnings */
-    int    numWarnings = 0;
-    size_t numPoints   = grid.numPoints();
+    int              numWarnings = 0;
+    size_t           numPoints   = grid.numPoints();
+    std::vector<int> neighborBuffer;
     for (size_t m = 0; m < numPoints; m++)
     {
         /* Skip points close to boundary or non-target region */
-        const GridPoint& gridPoint = grid.point(m);
-        bool             skipPoint = false;
-        for (size_t n = 0; (n < gridPoint.neighbor.size()) && !skipPoint; n++)
+        const std::vector<int>& neighbors = grid.neighborsWithoutStoring(m, &neighborBuffer);
+        bool                    skipPoint = false;
+        for (size_t n = 0; (n < neighbors.size()) && !skipPoint; n++)
         {
-            int neighbor = gridPoint.neighbor[n];
+            int neighbor = neighbors[n];
             skipPoint    = !points_[neighbor].inTargetRegion();
             for (int d = 0; (d < grid.numDimensions()) && !skipPoint; d++)
             {
@@ -517,7 +506,7 @@ void BiasState::calcConvolvedForce(const std::vector<DimParams>& dimParams,
     }
 
     /* Only neighboring points have non-negligible contribution. */
-    const std::vector<int>& neighbor          = grid.point(coordState_.gridpointIndex()).neighbor;
+    const std::vector<int>& neighbor          = grid.neighbors(coordState_.gridpointIndex());
     gmx::ArrayRef<double>   forceFromNeighbor = forceWorkBuffer;
     for (size_t n = 0; n < neighbor.size(); n++)
     {
@@ -671,7 +660,7 @@ void BiasState::doSkippedUpdatesInNeighborhood(const BiasParams& params, const B
     getSkippedUpdateHistogramScaleFactors(params, &weightHistScaling, &logPmfsumScaling);
 
     /* For each neighbor point of the center point, refresh its state by adding the results of all past, skipped updates. */
-    const std::vector<int>& neighbors = grid.point(coordState_.gridpointIndex()).neighbor;
+    const std::vector<int>& neighbors = grid.neighbors(coordState_.gridpointIndex());
     for (auto& neighbor : neighbors)
     {
         bool didUpdate = points_[neighbor].performPreviouslySkippedUpdates(
@@ -786,66 +775,93 @@ namespace
 {
 
 /*! \brief
- * Add partial histograms (accumulating between updates) to accumulating histograms.
+ * Add partial histograms (accumulating between updates) to accumulating histograms
+ * and sum the PMF over multiple simulations, when requested.
+ *
+ * When sharing, the weights and visit counts of the points in the update list and
+ * the PMF sums of all points are summed over the simulations in a single reduction.
+ * Note that the PMF sums of points outside the update list can also differ between
+ * the simulations, since skipped updates are applied to these when they are
+ * in the neighborhood of the current coordinate value.
  *
  * \param[in,out] pointState         The state of the points in the bias.
  * \param[in,out] weightSumCovering  The weights for checking covering.
  * \param[in]     numSharedUpdate    The number of biases sharing the histrogram.
  * \param[in]     commRecord         Struct for intra-simulation communication.
  * \param[in]     multiSimComm       Struct for multi-simulation communication.
- * \param[in]     localUpdateList    List of points with data.
+ * \param[in]     updateList         List of points with data, merged over the sharing simulations.
  */
-void sumHistograms(gmx::ArrayRef<PointState> pointState,
-                   gmx::ArrayRef<double>     weightSumCovering,
-                   int                       numSharedUpdate,
-                   const t_commrec*          commRecord,
-                   const gmx_multisim_t*     multiSimComm,
-                   const std::vector<int>&   localUpdateList)
+void sumHistogramsAndPmf(gmx::ArrayRef<PointState> pointState,
+                         gmx::ArrayRef<double>     weightSumCovering,
+                         int                       numSharedUpdate,
+                         const t_commrec*          commRecord,
+                         const gmx_multisim_t*     multiSimComm,
+                         const std::vector<int>&   updateList)
 {
     /* The covering checking histograms are added before summing over simulations, so that the
        weights from different simulations are kept distinguishable. */
-    for (int globalIndex : localUpdateList)
+    for (int globalIndex : updateList)
     {
         weightSumCovering[globalIndex] += pointState[globalIndex].weightSumIteration();
     }
 
-    /* Sum histograms over multiple simulations if needed. */
+    /* Sum histograms and PMF over multiple simulations if needed. */
     if (numSharedUpdate > 1)
     {
+        GMX_ASSERT(multiSimComm != nullptr && numSharedUpdate % multiSimComm->numSimulations_ == 0,
+                   "numSharedUpdate should be a multiple of multiSimComm->numSimulations_");
         GMX_ASSERT(numSharedUpdate == multiSimComm->numSimulations_,
                    "Sharing within a simulation is not implemented (yet)");
 
-        /* Collect the weights and counts in linear arrays to be able to use gmx_sumd_sim. */
-        std::vector<double> weightSum;
-        std::vector<double> coordVisits;
+        /* Collect the weights, counts and PMF sums in one linear array to be able
+           to use a single gmx_sumd_sim call. The PMF log weights need to be
+           exponentiated temporarily to sum them. */
+        const size_t        numUpdatePoints = updateList.size();
+        std::vector<double> buffer(2 * numUpdatePoints + pointState.size());
 
-        weightSum.resize(localUpdateList.size());
-        coordVisits.resize(localUpdateList.size());
+        gmx::ArrayRef<double> weightSum   = gmx::arrayRefFromArray(buffer.data(), numUpdatePoints);
+        gmx::ArrayRef<double> coordVisits = gmx::arrayRefFromArray(
+                buffer.data() + numUpdatePoints, numUpdatePoints);
+        gmx::ArrayRef<double> pmfSum = gmx::arrayRefFromArray(buffer.data() + 2 * numUpdatePoints,
+                                                              pointState.size());
 
-        for (size_t localIndex = 0; localIndex < localUpdateList.size(); localIndex++)
+        for (size_t localIndex = 0; localIndex < numUpdatePoints; localIndex++)
         {
-            const PointState& ps = pointState[localUpdateList[localIndex]];
+            const PointState& ps = pointState[updateList[localIndex]];
 
             weightSum[localIndex]   = ps.weightSumIteration();
             coordVisits[localIndex] = ps.numVisitsIteration();
         }
+        for (gmx::index i = 0; i < pointState.ssize(); i++)
+        {
+            pmfSum[i] = pointState[i].inTargetRegion() ? std::exp(-pointState[i].logPmfSum()) : 0;
+        }
 
-        sumOverSimulations(gmx::ArrayRef<double>(weightSum), commRecord, multiSimComm);
-        sumOverSimulations(gmx::ArrayRef<double>(coordVisits), commRecord, multiSimComm);
+        sumOverSimulations(gmx::ArrayRef<double>(buffer), commRecord, multiSimComm);
 
         /* Transfer back the result */
-        for (size_t localIndex = 0; localIndex < localUpdateList.size(); localIndex++)
+        for (size_t localIndex = 0; localIndex < numUpdatePoints; localIndex++)
         {
-            PointState& ps = pointState[localUpdateList[localIndex]];
+            PointState& ps = pointState[updateList[localIndex]];
 
             ps.setPartialWeightAndCount(weightSum[localIndex], coordVisits[localIndex]);
         }
+
+        /* Take log again to get (non-normalized) PMF */
+        const double normFac = 1.0 / numSharedUpdate;
+        for (gmx::index i = 0; i < pointState.ssize(); i++)
+        {
+            if (pointState[i].inTargetRegion())
+            {
+                pointState[i].setLogPmfSum(-std::log(pmfSum[i] * normFac));
+            }
+        }
     }
 
     /* Now add the partial counts and weights to the accumulating histograms.
        Note: we still need to use the weights for the update so we wait
        with resetting them until the end of the update. */
-    for (int globalIndex : localUpdateList)
+    for (int globalIndex : updateList)
     {
         pointState[globalIndex].addPartialWeightAndCount();
     }
@@ -1018,22 +1034,47 @@ bool BiasState::isSamplingRegionCovered(const BiasParams&             params,
         }
     }
 
-    /* Project the sampling weights onto each dimension */
-    for (size_t m = 0; m < grid.numPoints(); m++)
+    /* Project the sampling weights onto each dimension. With multiple threads,
+       each thread projects a block of points onto its own arrays and the arrays
+       of the other threads are merged into those of the first thread after. */
+    const int                          numThreads = numThreadsForPointLoop(grid.numPoints());
+    std::vector<std::vector<CheckDim>> threadCheckDim(numThreads - 1, checkDim);
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int thread = 0; thread < numThreads; thread++)
     {
-        const PointState& pointState = points_[m];
+        std::vector<CheckDim>& localCheckDim = (thread == 0 ? checkDim : threadCheckDim[thread - 1]);
 
-        for (int d = 0; d < grid.numDimensions(); d++)
+        const size_t pointBegin = (grid.numPoints() * thread) / numThreads;
+        const size_t pointEnd   = (grid.numPoints() * (thread + 1)) / numThreads;
+        for (size_t m = pointBegin; m < pointEnd; m++)
         {
-            int n = grid.point(m).index[d];
+            const PointState& pointState = points_[m];
 
-            /* Is visited if it was already visited or if there is enough weight at the current point */
-            checkDim[d].visited[n] = checkDim[d].visited[n] || (weightSumCovering_[m] > weightThreshold);
+            for (int d = 0; d < grid.numDimensions(); d++)
+            {
+                int n = grid.point(m).index[d];
 
-            /* Check for covering if there is at least point in this slice that is in the target region and within the cutoff */
-            checkDim[d].checkCovering[n] =
-                    checkDim[d].checkCovering[n]
-                    || (pointState.inTargetRegion() && pointState.freeEnergy() < maxFreeEnergy);
+                /* Is visited if it was already visited or if there is enough weight at the current point */
+                localCheckDim[d].visited[n] =
+                        localCheckDim[d].visited[n] || (weightSumCovering_[m] > weightThreshold);
+
+                /* Check for covering if there is at least point in this slice that is in the target region and within the cutoff */
+                localCheckDim[d].checkCovering[n] =
+                        localCheckDim[d].checkCovering[n]
+                        || (pointState.inTargetRegion() && pointState.freeEnergy() < maxFreeEnergy);
+            }
+        }
+    }
+    for (const std::vector<CheckDim>& localCheckDim : threadCheckDim)
+    {
+        for (int d = 0; d < grid.numDimensions(); d++)
+        {
+            for (int n = 0; n < grid.axis(d).numPoints(); n++)
+            {
+                checkDim[d].visited[n] = checkDim[d].visited[n] || localCheckDim[d].visited[n];
+                checkDim[d].checkCovering[n] =
+                        checkDim[d].checkCovering[n] || localCheckDim[d].checkCovering[n];
+            }
         }
     }
 
@@ -1091,9 +1132,11 @@ static void normalizeFreeEnergyAndPmfSum(std::vector<PointState>* pointState)
 {
     double minF = freeEnergyMinimumValue(*pointState);
 
-    for (PointState& ps : *pointState)
+    const int numThreads = numThreadsForPointLoop(pointState->size());
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (gmx::index m = 0; m < gmx::ssize(*pointState); m++)
     {
-        ps.normalizeFreeEnergyAndPmfSum(minF);
+        (*pointState)[m].normalizeFreeEnergyAndPmfSum(minF);
     }
 }
 
@@ -1127,9 +1170,8 @@ void BiasState::updateFreeEnergyAndAddSamplesToHistogram(const std::vector<DimPa
     resetLocalUpdateRange(grid);
 
     /* Add samples to histograms for all local points and sync simulations if needed */
-    sumHistograms(points_, weightSumCovering_, params.numSharedUpdate, commRecord, multiSimComm, *updateList);
-
-    sumPmf(points_, params.numSharedUpdate, commRecord, multiSimComm);
+    sumHistogramsAndPmf(points_, weightSumCovering_, params.numSharedUpdate, commRecord,
+                        multiSimComm, *updateList);
 
     /* Renormalize the free energy if values are too large. */
     bool needToNormalizeFreeEnergy = false;
@@ -1201,10 +1243,15 @@ void BiasState::updateFreeEnergyAndAddSamplesToHistogram(const std::vector<DimPa
     setHistogramUpdateScaleFactors(params, newHistogramSize, histogramSize_.histogramSize(),
                                    &weightHistScalingNew, &logPmfsumScalingNew);
 
-    /* Update free energy and reference weight histogram for points in the update list. */
-    for (int pointIndex : *updateList)
+    /* Update free energy and reference weight histogram for points in the update list.
+     * The points are independent, so we can use multiple threads.
+     */
+    const gmx::ArrayRef<const int> pointsToUpdate = *updateList;
+    const int                      numThreads     = numThreadsForPointLoop(pointsToUpdate.size());
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (gmx::index i = 0; i < pointsToUpdate.ssize(); i++)
     {
-        PointState* pointStateToUpdate = &points_[pointIndex];
+        PointState* pointStateToUpdate = &points_[pointsToUpdate[i]];
 
         /* Do updates from previous update steps that were skipped because this point was at that time non-local. */
         if (params.skipUpdates())
@@ -1235,9 +1282,10 @@ void BiasState::updateFreeEnergyAndAddSamplesToHistogram(const std::vector<DimPa
 
     /* Update the bias. The bias is updated separately and last since it simply a function of
        the free energy and the target distribution and we want to avoid doing extra work. */
-    for (int pointIndex : *updateList)
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (gmx::index i = 0; i < pointsToUpdate.ssize(); i++)
     {
-        points_[pointIndex].updateBias();
+        points_[pointsToUpdate[i]].updateBias();
     }
 
     /* Increase the update counter. */
@@ -1250,7 +1298,7 @@ double BiasState::updateProbabilityWeightsAndConvolvedBias(const std::vector<Dim
                                                            std::vector<double, AlignedAllocator<double>>* weight) const
 {
     /* Only neighbors of the current coordinate value will have a non-negligible chance of getting sampled */
-    const std::vector<int>& neighbors = grid.point(coordState_.gridpointIndex()).neighbor;
+    const std::vector<int>& neighbors = grid.neighbors(coordState_.gridpointIndex());
 
 #if GMX_SIMD_HAVE_DOUBLE
     typedef SimdDouble PackType;
@@ -1331,12 +1379,15 @@ double BiasState::calcConvolvedBias(const std::vector<DimParams>& dimParams,
                                     const BiasGrid&               grid,
                                     const awh_dvec&               coordValue) const
 {
-    int              point     = grid.nearestIndex(coordValue);
-    const GridPoint& gridPoint = grid.point(point);
+    int point = grid.nearestIndex(coordValue);
 
-    /* Sum the probability weights from the neighborhood of the given point */
-    double weightSum = 0;
-    for (int neighbor : gridPoint.neighbor)
+    /* Sum the probability weights from the neighborhood of the given point.
+     * This is also called for all points when writing output, so we should
+     * not store the neighbor lists of all points.
+     */
+    std::vector<int> neighborBuffer;
+    double           weightSum = 0;
+    for (int neighbor : grid.neighborsWithoutStoring(point, &neighborBuffer))
     {
         /* No convolution is required along the lambda dimension. */
         if (pointsHaveDifferentLambda(grid, point, neighbor))
@@ -1354,7 +1405,7 @@ double BiasState::calcConvolvedBias(const std::vector<DimParams>& dimParams,
 
 void BiasState::sampleProbabilityWeights(const BiasGrid& grid, gmx::ArrayRef<const double> probWeightNeighbor)
 {
-    const std::vector<int>& neighbor = grid.point(coordState_.gridpointIndex()).neighbor;
+    const std::vector<int>& neighbor = grid.neighbors(coordState_.gridpointIndex());
 
     /* Save weights for next update */
     for (size_t n = 0; n < neighbor.size(); n++)
@@ -1430,7 +1481,7 @@ void BiasState::sampleCoordAndPmf(const std::vector<DimParams>& dimParams,
     /* Update the PMF of points along a lambda axis with their bias. */
     if (lambdaAxisIndex)
     {
-        const std::vector<int>& neighbors = grid.point(gridPointIndex).neighbor;
+        const std::vector<int>& neighbors = grid.neighbors(gridPointIndex);
 
         std::vector<double> lambdaMarginalDistribution =
                 calculateFELambdaMarginalDistribution(grid, neighbors, probWeightNeighbor);
@@ -115,7 +115,7 @@ TEST(biasGridTest, neighborhood)
     /* Checking for all points is overkill, we check every 7th */
     for (size_t i = 0; i < grid.numPoints(); i += 7)
     {
-        const GridPoint& point = grid.point(i);
+        const std::vector<int>& neighbors = grid.neighbors(i);
 
         /* NOTE: This code relies on major-minor index ordering in Grid */
         int pointIndex0 = i / numPointsDim[1];
@@ -128,12 +128,12 @@ TEST(biasGridTest, neighborhood)
         int    distanceFromEdge1 = std::min(pointIndex1, numPointsDim[1] - 1 - pointIndex1);
         size_t numNeighbors      = (2 * scopeInPoints + 1)
                               * (scopeInPoints + std::min(scopeInPoints, distanceFromEdge1) + 1);
-        if (point.neighbor.size() != numNeighbors)
+        if (neighbors.size() != numNeighbors)
         {
             haveCorrectNumNeighbors = false;
         }
 
-        for (auto& j : point.neighbor)
+        for (auto& j : neighbors)
         {
             if (j >= 0 && j < numPoints)
             {
@@ -171,7 +171,7 @@ TEST(biasGridTest, neighborhood)
         }
 
         /* Clear the marked points in the checking grid */
-        for (auto& neighbor : point.neighbor)
+        for (auto& neighbor : neighbors)
         {
             if (neighbor >= 0 && neighbor < numPoints)
             {
@@ -186,5 +186,45 @@ TEST(biasGridTest, neighborhood)
     EXPECT_TRUE(haveCorrectNumNeighbors);
 }
 
+TEST(biasGridTest, neighborListsAreStoredOnlyOnRequest)
+{
+    std::vector<AwhDimParams> awhDimParams(2);
+
+    awhDimParams[0].origin = -5;
+    awhDimParams[0].end    = 5;
+    awhDimParams[0].period = 10;
+
+    awhDimParams[1].origin = 0.5;
+    awhDimParams[1].end    = 2.0;
+    awhDimParams[1].period = 0;
+
+    const real conversionFactor = 1;
+    const real beta             = 3.0;
+
+    std::vector<DimParams> dimParams;
+    dimParams.push_back(DimParams::pullDimParams(conversionFactor, 1 / (beta * 0.7 * 0.7), beta));
+    dimParams.push_back(DimParams::pullDimParams(conversionFactor, 1 / (beta * 0.1 * 0.1), beta));
+
+    BiasGrid grid(dimParams, awhDimParams.data());
+
+    EXPECT_EQ(grid.numPointsWithStoredNeighbors(), 0);
+
+    /* Generating without storing should not change the storage */
+    std::vector<int> buffer;
+    for (size_t i = 0; i < grid.numPoints(); i++)
+    {
+        grid.neighborsWithoutStoring(i, &buffer);
+    }
+    EXPECT_EQ(grid.numPointsWithStoredNeighbors(), 0);
+
+    const std::vector<int> unstoredNeighbors = grid.neighborsWithoutStoring(3, &buffer);
+    EXPECT_EQ(grid.neighbors(3), unstoredNeighbors);
+    EXPECT_EQ(grid.numPointsWithStoredNeighbors(), 1);
+
+    /* Once stored, the stored list should be returned */
+    EXPECT_EQ(&grid.neighborsWithoutStoring(3, &buffer), &grid.neighbors(3));
+    EXPECT_EQ(grid.numPointsWithStoredNeighbors(), 1);
+}
+
 } // namespace test
 } // namespace gmx
@@ -43,6 +43,7 @@
 
 #include "densityfittingforceprovider.h"
 
+#include <algorithm>
 #include <numeric>
 #include <optional>
 
@@ -51,12 +52,16 @@
 #include "gromacs/math/coordinatetransformation.h"
 #include "gromacs/math/densityfit.h"
 #include "gromacs/math/densityfittingforce.h"
+#include "gromacs/math/functions.h"
 #include "gromacs/math/gausstransform.h"
 #include "gromacs/mdlib/broadcaststructs.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
 #include "gromacs/mdtypes/commrec.h"
 #include "gromacs/mdtypes/enerdata.h"
 #include "gromacs/mdtypes/forceoutput.h"
 #include "gromacs/pbcutil/pbc.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/strconvert.h"
 
 #include "densityfittingamplitudelookup.h"
@@ -84,6 +89,28 @@ GaussianSpreadKernelParameters::Shape makeSpreadKernel(real sigma, real nSigma,
              nSigma };
 }
 
+/*! \internal \brief Flag the lattice planes along z that receive contributions when
+ * spreading Gaussians at the given lattice coordinates.
+ *
+ * \param[in] coordinates in lattice coordinates
+ * \param[in] spreadRange the spread range of the kernel along z in lattice points
+ * \param[out] planeIsSpreadTo set to one for planes that are spread to, others are untouched
+ */
+void flagPlanesSpreadTo(ArrayRef<const RVec> coordinates, int spreadRange, ArrayRef<int> planeIsSpreadTo)
+{
+    const int numPlanes = planeIsSpreadTo.ssize();
+    for (const RVec& r : coordinates)
+    {
+        const int closestPlane = roundToInt(r[ZZ]);
+        const int planeBegin   = std::max(closestPlane - spreadRange, 0);
+        const int planeEnd     = std::min(closestPlane + spreadRange, numPlanes);
+        for (int plane = planeBegin; plane < planeEnd; plane++)
+        {
+            planeIsSpreadTo[plane] = 1;
+        }
+    }
+}
+
 } // namespace
 
 /********************************************************************
@@ -169,7 +196,10 @@ private:
     GaussianSpreadKernelParameters::Shape spreadKernel_;
     GaussTransform3D                      gaussTransform_;
     DensitySimilarityMeasure              measure_;
-    DensityFittingForce                   densityFittingForce_;
+    //! Force evaluators with their scratch memory, one per thread
+    std::vector<DensityFittingForce> densityFittingForce_;
+    //! Flags for the lattice planes along z that are spread to by any rank
+    std::vector<int> planeIsSpreadTo_;
     //! the local atom coordinates transformed into the grid coordinate system
     std::vector<RVec>             transformedCoordinates_;
     std::vector<RVec>             forces_;
@@ -202,7 +232,7 @@ DensityFittingForceProvider::Impl::Impl(const DensityFittingParameters&
                                    transformationToDensityLattice.scaleOperationOnly())),
     gaussTransform_(referenceDensity.extents(), spreadKernel_),
     measure_(parameters.similarityMeasureMethod_, referenceDensity),
-    densityFittingForce_(spreadKernel_),
+    densityFittingForce_({ DensityFittingForce(spreadKernel_) }),
     transformedCoordinates_(localAtomSet_.numAtomsLocal()),
     amplitudeLookup_(parameters_.amplitudeLookupMethod_),
     transformationToDensityLattice_(transformationToDensityLattice),
@@ -291,6 +321,8 @@ void DensityFittingForceProvider::Impl::calculateForces(const ForceProviderInput
     // transform local atom coordinates to density grid coordinates
     transformationToDensityLattice_(transformedCoordinates_);
 
+    const int numThreads = std::max(1, gmx_omp_nthreads_get(emntDefault));
+
     // spread atoms on grid
     gaussTransform_.setZero();
 
@@ -310,32 +342,59 @@ void DensityFittingForceProvider::Impl::calculateForces(const ForceProviderInput
         }
     }
 
-    auto amplitudeIterator = amplitudes.cbegin();
-
-    for (const auto& r : transformedCoordinates_)
-    {
-        gaussTransform_.add({ r, *amplitudeIterator });
-        ++amplitudeIterator;
-    }
+    gaussTransform_.add(transformedCoordinates_, amplitudes, numThreads);
 
     // communicate grid
     if (havePPDomainDecomposition(&forceProviderInput.cr_))
     {
-        // \todo update to real once GaussTransform class returns real
-        gmx_sumf(gaussTransform_.view().mapping().required_span_size(),
-                 gaussTransform_.view().data(), &forceProviderInput.cr_);
+        // Only sum the planes between the first and last plane that any rank spread to,
+        // all other lattice values are zero on all ranks
+        const auto lattice   = gaussTransform_.view();
+        const int  numPlanes = lattice.extent(0);
+        planeIsSpreadTo_.assign(numPlanes, 0);
+        flagPlanesSpreadTo(transformedCoordinates_, spreadKernel_.latticeSpreadRange()[ZZ],
+                           planeIsSpreadTo_);
+        gmx_sumi(numPlanes, planeIsSpreadTo_.data(), &forceProviderInput.cr_);
+        const auto firstPlane = std::find_if(planeIsSpreadTo_.begin(), planeIsSpreadTo_.end(),
+                                             [](int flag) { return flag != 0; });
+        if (firstPlane != planeIsSpreadTo_.end())
+        {
+            const auto lastPlane = std::find_if(planeIsSpreadTo_.rbegin(), planeIsSpreadTo_.rend(),
+                                                [](int flag) { return flag != 0; });
+            const int planeBegin = std::distance(planeIsSpreadTo_.begin(), firstPlane);
+            const int planeEnd   = numPlanes - std::distance(planeIsSpreadTo_.rbegin(), lastPlane);
+            const int planeSize  = lattice.mapping().required_span_size() / numPlanes;
+            // \todo update to real once GaussTransform class returns real
+            gmx_sumf((planeEnd - planeBegin) * planeSize, lattice.data() + planeBegin * planeSize,
+                     &forceProviderInput.cr_);
+        }
     }
 
     // calculate grid derivative
     const DensitySimilarityMeasure::density& densityDerivative =
             measure_.gradient(gaussTransform_.constView());
-    // calculate forces
+    // calculate forces, each thread uses its own force evaluator for the scratch memory
     forces_.resize(localAtomSet_.numAtomsLocal());
-    std::transform(
-            std::begin(transformedCoordinates_), std::end(transformedCoordinates_), std::begin(amplitudes),
-            std::begin(forces_), [&densityDerivative, this](const RVec r, real amplitude) {
-                return densityFittingForce_.evaluateForce({ r, amplitude }, densityDerivative);
-            });
+    if (gmx::ssize(densityFittingForce_) < numThreads)
+    {
+        densityFittingForce_.resize(numThreads, densityFittingForce_[0]);
+    }
+    const int numAtomsLocal = gmx::ssize(transformedCoordinates_);
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int thread = 0; thread < numThreads; thread++)
+    {
+        try
+        {
+            const int atomBegin = (thread * numAtomsLocal) / numThreads;
+            const int atomEnd   = ((thread + 1) * numAtomsLocal) / numThreads;
+            for (int i = atomBegin; i < atomEnd; i++)
+            {
+                forces_[i] = densityFittingForce_[thread].evaluateForce(
+                        { transformedCoordinates_[i], amplitudes[i] }, densityDerivative);
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
 
     transformationToDensityLattice_.scaleOperationOnly().inverseIgnoringZeroScale(forces_);
 
@@ -80,23 +80,23 @@ int many_auto_correl(std::vector<std::vector<real>>* c)
     {
         i.resize(nfft, 0);
     }
-#pragma omp parallel
+    // Use at most one thread per function, so no FFT plans are set up without use
+    const int nthreads = std::max(1, std::min(gmx_omp_get_max_threads(), static_cast<int>(nfunc)));
+#pragma omp parallel num_threads(nthreads)
     {
         try
         {
             gmx_fft_t         fft1;
             std::vector<real> in, out;
 
-            int nthreads  = gmx_omp_get_max_threads();
-            int thread_id = gmx_omp_get_thread_num();
-            int i0        = (thread_id * nfunc) / nthreads;
-            int i1        = std::min(nfunc, ((thread_id + 1) * nfunc) / nthreads);
-
             gmx_fft_init_1d(&fft1, nfft, GMX_FFT_FLAG_CONSERVATIVE);
             /* Allocate temporary arrays */
             in.resize(2 * nfft, 0);
             out.resize(2 * nfft, 0);
-            for (int i = i0; (i < i1); i++)
+            // Distribute the functions over the threads that are actually
+            // running, which is only one when called from a parallel region
+#pragma omp for schedule(static)
+            for (int i = 0; i < static_cast<int>(nfunc); i++)
             {
                 for (size_t j = 0; j < ndata; j++)
                 {
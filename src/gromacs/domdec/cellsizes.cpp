@@ -47,11 +47,16 @@
 
 #include "config.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "gromacs/gmxlib/network.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/mdtypes/commrec.h"
 #include "gromacs/utility/cstringutil.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/gmxassert.h"
 
 #include "atomdistribution.h"
 #include "domdec_internal.h"
@@ -556,6 +561,66 @@ static void dd_cell_sizes_dlb_root_enforce_limits(gmx_domdec_t*      dd,
 }
 
 
+void predictBalancedCellSizes(gmx::ArrayRef<const real> cellFrac,
+                              gmx::ArrayRef<const real> cellLoad,
+                              real                      relax,
+                              real                      changeLimit,
+                              gmx::ArrayRef<real>       cellSize)
+{
+    const int numCells = cellLoad.ssize();
+
+    GMX_ASSERT(cellFrac.ssize() == numCells + 1 && cellSize.ssize() == numCells,
+               "We need one more boundary than cells");
+
+    real totalLoad = 0;
+    for (const real load : cellLoad)
+    {
+        totalLoad += std::max(load, real(0));
+    }
+    if (totalLoad <= 0)
+    {
+        for (int i = 0; i < numCells; i++)
+        {
+            cellSize[i] = cellFrac[i + 1] - cellFrac[i];
+        }
+        return;
+    }
+
+    /* With larger limits boundaries could cross each other */
+    changeLimit = std::min(changeLimit, real(1));
+
+    real boundaryPrev = cellFrac[0];
+    /* The cell and the cumulative load up to the start of that cell */
+    int  cell           = 0;
+    real cumulativeLoad = 0;
+    for (int b = 1; b < numCells; b++)
+    {
+        /* Find the position where the cumulative load reaches its target */
+        const real targetLoad = (b * totalLoad) / numCells;
+        while (cell < numCells - 1 && cumulativeLoad + std::max(cellLoad[cell], real(0)) <= targetLoad)
+        {
+            cumulativeLoad += std::max(cellLoad[cell], real(0));
+            cell++;
+        }
+        const real width     = cellFrac[cell + 1] - cellFrac[cell];
+        real       predicted = cellFrac[cell];
+        if (cellLoad[cell] > 0)
+        {
+            predicted += std::min((targetLoad - cumulativeLoad) / cellLoad[cell], real(1)) * width;
+        }
+
+        /* Damp and limit the shift of the boundary */
+        const real maxShift = 0.5 * changeLimit
+                              * std::min(cellFrac[b] - cellFrac[b - 1], cellFrac[b + 1] - cellFrac[b]);
+        const real shift = std::clamp(relax * (predicted - cellFrac[b]), -maxShift, maxShift);
+        const real boundary = cellFrac[b] + shift;
+
+        cellSize[b - 1] = boundary - boundaryPrev;
+        boundaryPrev    = boundary;
+    }
+    cellSize[numCells - 1] = cellFrac[numCells] - boundaryPrev;
+}
+
 static void set_dd_cell_sizes_dlb_root(gmx_domdec_t*      dd,
                                        int                d,
                                        int                dim,
@@ -590,6 +655,15 @@ static void set_dd_cell_sizes_dlb_root(gmx_domdec_t*      dd,
             cell_size[i] = 1.0 / ncd;
         }
     }
+    else if (dd_load_count(comm) > 0 && comm->ddSettings.useDlbCostModel)
+    {
+        std::vector<real> cellLoad(ncd);
+        for (int i = 0; i < ncd; i++)
+        {
+            cellLoad[i] = comm->load[d].load[i * comm->load[d].nload + 2];
+        }
+        predictBalancedCellSizes(rowMaster->oldCellFrac, cellLoad, c_relax, change_limit, cell_size);
+    }
     else if (dd_load_count(comm) > 0)
     {
         real load_aver  = comm->load[d].sum_m / ncd;
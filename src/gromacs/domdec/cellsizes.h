@@ -77,6 +77,26 @@ real grid_jump_limit(const gmx_domdec_comm_t* comm, real cutoff, int dim_ind);
 gmx::ArrayRef<const std::vector<real>>
 set_dd_cell_sizes_slb(gmx_domdec_t* dd, const gmx_ddbox_t* ddbox, int setmode, ivec numPulses);
 
+/*! \brief Predicts the cell sizes that balance the load along a row of cells
+ *
+ * The measured load of each cell is assumed to be distributed uniformly
+ * over the cell. The cell boundaries that give equal load in all cells under
+ * this piecewise constant cost model are computed directly. The shift of
+ * each boundary towards its predicted position is damped by \p relax and
+ * limited such that cell sizes change by at most a fraction \p changeLimit.
+ *
+ * \param[in]  cellFrac     The current relative cell boundaries, size #cells+1
+ * \param[in]  cellLoad     The measured load of each cell
+ * \param[in]  relax        The damping factor for the boundary shifts, between 0 and 1
+ * \param[in]  changeLimit  The maximum relative change of the cell sizes
+ * \param[out] cellSize     The new relative cell sizes
+ */
+void predictBalancedCellSizes(gmx::ArrayRef<const real> cellFrac,
+                              gmx::ArrayRef<const real> cellLoad,
+                              real                      relax,
+                              real                      changeLimit,
+                              gmx::ArrayRef<real>       cellSize);
+
 /*! \brief General cell size adjustment, possibly applying dynamic load balancing */
 void set_dd_cell_sizes(gmx_domdec_t*      dd,
                        const gmx_ddbox_t* ddbox,
@@ -0,0 +1,650 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ *
+ * \brief Defines functions for communicating the halo with all
+ * neighboring domains in a single round.
+ *
+ * \ingroup module_domdec
+ */
+
+#include "gmxpre.h"
+
+#include "directhalo.h"
+
+#include "config.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "gromacs/domdec/ga2la.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/mdtypes/forceoutput.h"
+#include "gromacs/pbcutil/ishift.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxmpi.h"
+
+#include "domdec_internal.h"
+
+namespace
+{
+
+//! MPI tag for the direct halo communication
+constexpr int c_directHaloMpiTag = 7;
+
+/*! \brief Returns the ranks of the domains at all cell offset combinations along the DD dimensions
+ *
+ * The offsets along DD dimension index d run from 0 to the number of pulses
+ * along d, with sign \p sign. The entries are ordered with the offset along
+ * dimension index 0 running fastest. The first entry is our own rank.
+ */
+std::vector<int> getOffsetDomainRanks(gmx_domdec_t* dd, int sign)
+{
+    std::vector<gmx::IVec> cells = { gmx::IVec(dd->ci) };
+    for (int d = 0; d < dd->ndim; d++)
+    {
+        const int dim        = dd->dim[d];
+        const int numCells   = dd->numCells[dim];
+        const int numOffsets = dd->comm->cd[d].numPulses() + 1;
+        const int numPrev    = gmx::ssize(cells);
+        cells.resize(numPrev * numOffsets);
+        for (int k = 1; k < numOffsets; k++)
+        {
+            for (int c = 0; c < numPrev; c++)
+            {
+                gmx::IVec& cell = cells[k * numPrev + c];
+                cell            = cells[c];
+                cell[dim]       = (cell[dim] + sign * k + numCells) % numCells;
+            }
+        }
+    }
+
+    std::vector<int> ranks;
+    ranks.reserve(cells.size());
+    for (const gmx::IVec& cell : cells)
+    {
+        ranks.push_back(ddcoord2ddnodeid(dd, cell.as_vec()));
+    }
+
+    return ranks;
+}
+
+//! Returns the sorted list of unique ranks in \p ranks, excluding \p ownRank
+std::vector<int> uniqueNeighborRanks(gmx::ArrayRef<const int> ranks, int ownRank)
+{
+    std::vector<int> neighborRanks;
+    for (int rank : ranks)
+    {
+        if (rank != ownRank)
+        {
+            neighborRanks.push_back(rank);
+        }
+    }
+    std::sort(neighborRanks.begin(), neighborRanks.end());
+    neighborRanks.erase(std::unique(neighborRanks.begin(), neighborRanks.end()), neighborRanks.end());
+
+    return neighborRanks;
+}
+
+//! Returns the index of \p rank in the sorted list \p ranks
+int rankIndex(gmx::ArrayRef<const int> ranks, int rank)
+{
+    const auto it = std::lower_bound(ranks.begin(), ranks.end(), rank);
+    GMX_RELEASE_ASSERT(it != ranks.end() && *it == rank,
+                       "Halo atoms should only originate from neighbor ranks");
+
+    return std::distance(ranks.begin(), it);
+}
+
+/*! \brief Sets the contiguity and buffer offsets of \p neighbors and returns the total buffer size
+ *
+ * Neighbors with an empty atom list are removed.
+ */
+int setNeighborBufferLayout(std::vector<DDDirectHaloSetup::Neighbor>* neighbors)
+{
+    neighbors->erase(std::remove_if(neighbors->begin(), neighbors->end(),
+                                    [](const DDDirectHaloSetup::Neighbor& neighbor) {
+                                        return neighbor.atomIndices.empty();
+                                    }),
+                     neighbors->end());
+
+    int bufferSize = 0;
+    for (DDDirectHaloSetup::Neighbor& neighbor : *neighbors)
+    {
+        const std::vector<int>& atoms = neighbor.atomIndices;
+
+        bool isContiguous = true;
+        for (size_t i = 1; i < atoms.size(); i++)
+        {
+            if (atoms[i] != atoms[i - 1] + 1)
+            {
+                isContiguous = false;
+                break;
+            }
+        }
+        neighbor.contiguousStart = (isContiguous ? atoms[0] : -1);
+        neighbor.bufferOffset    = bufferSize;
+        bufferSize += gmx::ssize(atoms);
+    }
+
+    return bufferSize;
+}
+
+#if GMX_LIB_MPI
+/*! \brief Frees the persistent requests in \p persistentRequests */
+void freePersistentRequests(DDDirectHaloSetup::PersistentRequests* persistentRequests)
+{
+    for (MPI_Request& request : persistentRequests->requests)
+    {
+        MPI_Request_free(&request);
+    }
+    persistentRequests->requests.clear();
+    persistentRequests->data = nullptr;
+}
+
+//! Frees all persistent requests in \p persistentRequestsList
+void freePersistentRequests(std::vector<DDDirectHaloSetup::PersistentRequests>* persistentRequestsList)
+{
+    for (DDDirectHaloSetup::PersistentRequests& persistentRequests : *persistentRequestsList)
+    {
+        freePersistentRequests(&persistentRequests);
+    }
+    persistentRequestsList->clear();
+}
+
+/*! \brief Returns the entry for local array \p data in \p persistentRequestsList
+ *
+ * When there is no entry for \p data, an entry without requests is added.
+ * When the list is full, the oldest entry is freed and removed.
+ */
+DDDirectHaloSetup::PersistentRequests*
+getPersistentRequests(std::vector<DDDirectHaloSetup::PersistentRequests>* persistentRequestsList,
+                      const gmx::RVec*                                    data)
+{
+    for (DDDirectHaloSetup::PersistentRequests& persistentRequests : *persistentRequestsList)
+    {
+        if (persistentRequests.data == data)
+        {
+            return &persistentRequests;
+        }
+    }
+
+    if (persistentRequestsList->size() == DDDirectHaloSetup::c_maxNumPersistentArrays)
+    {
+        freePersistentRequests(&persistentRequestsList->front());
+        persistentRequestsList->erase(persistentRequestsList->begin());
+    }
+    persistentRequestsList->emplace_back();
+    persistentRequestsList->back().data = data;
+
+    return &persistentRequestsList->back();
+}
+
+/*! \brief Returns persistent requests for communicating coordinates with \p x as local array
+ *
+ * The receive requests are stored first, followed by the send requests.
+ * The requests are set up on the first call for \p x after partitioning.
+ */
+MPI_Request* persistentCoordinateRequests(gmx_domdec_t* dd, gmx::RVec* x)
+{
+    DDDirectHaloSetup&                     setup = dd->comm->directHalo;
+    DDDirectHaloSetup::PersistentRequests& persistent = *getPersistentRequests(&setup.persistentX, x);
+    if (!persistent.requests.empty())
+    {
+        return persistent.requests.data();
+    }
+
+    persistent.requests.resize(setup.receive.size() + setup.send.size());
+    int numRequests = 0;
+    for (const DDDirectHaloSetup::Neighbor& neighbor : setup.receive)
+    {
+        gmx::RVec* buffer = (neighbor.contiguousStart >= 0)
+                                    ? x + neighbor.contiguousStart
+                                    : setup.receiveBuffer.data() + neighbor.bufferOffset;
+        MPI_Recv_init(buffer, neighbor.atomIndices.size() * sizeof(rvec), MPI_BYTE, neighbor.rank,
+                      c_directHaloMpiTag, dd->mpi_comm_all, &persistent.requests[numRequests++]);
+    }
+    for (const DDDirectHaloSetup::Neighbor& neighbor : setup.send)
+    {
+        MPI_Send_init(setup.sendBuffer.data() + neighbor.bufferOffset,
+                      neighbor.atomIndices.size() * sizeof(rvec), MPI_BYTE, neighbor.rank,
+                      c_directHaloMpiTag, dd->mpi_comm_all, &persistent.requests[numRequests++]);
+    }
+
+    return persistent.requests.data();
+}
+
+/*! \brief Returns persistent requests for communicating forces with \p f as local array
+ *
+ * The receive requests are stored first, followed by the send requests.
+ * The requests are set up on the first call for \p f after partitioning.
+ */
+MPI_Request* persistentForceRequests(gmx_domdec_t* dd, gmx::RVec* f)
+{
+    DDDirectHaloSetup&                     setup = dd->comm->directHalo;
+    DDDirectHaloSetup::PersistentRequests& persistent = *getPersistentRequests(&setup.persistentF, f);
+    if (!persistent.requests.empty())
+    {
+        return persistent.requests.data();
+    }
+
+    persistent.requests.resize(setup.send.size() + setup.receive.size());
+    int numRequests = 0;
+    for (const DDDirectHaloSetup::Neighbor& neighbor : setup.send)
+    {
+        MPI_Recv_init(setup.sendBuffer.data() + neighbor.bufferOffset,
+                      neighbor.atomIndices.size() * sizeof(rvec), MPI_BYTE, neighbor.rank,
+                      c_directHaloMpiTag, dd->mpi_comm_all, &persistent.requests[numRequests++]);
+    }
+    for (const DDDirectHaloSetup::Neighbor& neighbor : setup.receive)
+    {
+        gmx::RVec* buffer = (neighbor.contiguousStart >= 0)
+                                    ? f + neighbor.contiguousStart
+                                    : setup.receiveBuffer.data() + neighbor.bufferOffset;
+        MPI_Send_init(buffer, neighbor.atomIndices.size() * sizeof(rvec), MPI_BYTE, neighbor.rank,
+                      c_directHaloMpiTag, dd->mpi_comm_all, &persistent.requests[numRequests++]);
+    }
+
+    return persistent.requests.data();
+}
+#endif
+
+} // namespace
+
+DDDirectHaloSetup::~DDDirectHaloSetup()
+{
+#if GMX_LIB_MPI
+    /* The persistent requests can only be freed while MPI is active */
+    int mpiIsFinalized = 0;
+    MPI_Finalized(&mpiIsFinalized);
+    if (!mpiIsFinalized)
+    {
+        freePersistentRequests(&persistentX);
+        freePersistentRequests(&persistentF);
+    }
+#endif
+}
+
+void setupDirectHaloExchange(gmx_domdec_t* dd)
+{
+#if GMX_MPI
+    GMX_RELEASE_ASSERT(!dd->unitCellInfo.haveScrewPBC,
+                       "The direct halo exchange does not support screw PBC");
+
+    DDDirectHaloSetup& setup = dd->comm->directHalo;
+
+    const int numHomeAtoms = dd->comm->atomRanges.numHomeAtoms();
+    const int numAtoms     = dd->comm->atomRanges.end(DDAtomRanges::Type::Zones);
+    for (int d = 0; d < dd->ndim; d++)
+    {
+        GMX_RELEASE_ASSERT(dd->comm->cd[d].numPulses() < (1 << c_directHaloOriginBitsPerDim),
+                           "The number of pulses should fit in the packed atom origin");
+    }
+    GMX_RELEASE_ASSERT(gmx::ssize(setup.atomOrigins) >= numAtoms,
+                       "The halo atom origins should have been set with the pulse setup");
+
+    /* The candidate partner ranks follow from the DD grid and the pulse
+     * counts, which are uniform over the ranks, so the two sets are
+     * consistent among ranks, as is required for matching communication.
+     */
+    const std::vector<int> sourceCellRanks = getOffsetDomainRanks(dd, 1);
+    const std::vector<int> destCellRanks   = getOffsetDomainRanks(dd, -1);
+    const std::vector<int> sourceRanks     = uniqueNeighborRanks(sourceCellRanks, dd->rank);
+    const std::vector<int> destRanks       = uniqueNeighborRanks(destCellRanks, dd->rank);
+
+    /* Collect for each source rank the halo atoms we receive from it
+     * and the list of global atom indices to request from it.
+     * The first element of a request list holds the shift flags.
+     */
+    setup.receive.resize(sourceRanks.size());
+    std::vector<std::vector<int>> requestLists(sourceRanks.size());
+    for (size_t s = 0; s < sourceRanks.size(); s++)
+    {
+        setup.receive[s].rank = sourceRanks[s];
+        setup.receive[s].atomIndices.clear();
+    }
+    for (int i = numHomeAtoms; i < numAtoms; i++)
+    {
+        const int origin      = setup.atomOrigins[i];
+        int       offsetIndex = 0;
+        int       stride      = 1;
+        int       shiftFlags  = 0;
+        for (int d = 0; d < dd->ndim; d++)
+        {
+            const int offset = ddDirectHaloOriginOffset(origin, d);
+            offsetIndex += offset * stride;
+            stride *= dd->comm->cd[d].numPulses() + 1;
+            /* The coordinates are shifted when they pass the periodic boundary */
+            if (dd->ci[dd->dim[d]] + offset >= dd->numCells[dd->dim[d]])
+            {
+                shiftFlags |= (1 << d);
+            }
+        }
+        const int         s           = rankIndex(sourceRanks, sourceCellRanks[offsetIndex]);
+        std::vector<int>& requestList = requestLists[s];
+        if (requestList.empty())
+        {
+            requestList.push_back(shiftFlags);
+        }
+        GMX_ASSERT(shiftFlags == requestList[0],
+                   "All atoms from one rank should be shifted by the same vector");
+        requestList.push_back(dd->globalAtomGroupIndices[i]);
+        setup.receive[s].atomIndices.push_back(i);
+    }
+
+    /* Exchange the request lists in a single round. We do not know
+     * the sizes of the incoming lists, but they are bounded by the number
+     * of our home atoms plus one, since each atom occurs once in a halo.
+     */
+    const int maxRequestListSize = 1 + numHomeAtoms;
+    setup.requestListBuffer.resize(destRanks.size() * maxRequestListSize);
+    std::vector<MPI_Request>& requests = setup.requests;
+    requests.resize(destRanks.size() + sourceRanks.size());
+    std::vector<MPI_Status> statuses(destRanks.size());
+    for (size_t s = 0; s < destRanks.size(); s++)
+    {
+        MPI_Irecv(setup.requestListBuffer.data() + s * maxRequestListSize, maxRequestListSize,
+                  MPI_INT, destRanks[s], c_directHaloMpiTag, dd->mpi_comm_all, &requests[s]);
+    }
+    for (size_t s = 0; s < sourceRanks.size(); s++)
+    {
+        MPI_Isend(requestLists[s].data(), requestLists[s].size(), MPI_INT, sourceRanks[s],
+                  c_directHaloMpiTag, dd->mpi_comm_all, &requests[destRanks.size() + s]);
+    }
+    MPI_Waitall(destRanks.size(), requests.data(), statuses.data());
+    MPI_Waitall(sourceRanks.size(), requests.data() + destRanks.size(), MPI_STATUSES_IGNORE);
+
+    const gmx_ga2la_t& ga2la = *dd->ga2la;
+    setup.send.resize(destRanks.size());
+    for (size_t s = 0; s < destRanks.size(); s++)
+    {
+        DDDirectHaloSetup::Neighbor& neighbor = setup.send[s];
+        neighbor.rank                         = destRanks[s];
+        neighbor.atomIndices.clear();
+
+        int requestListSize = 0;
+        MPI_Get_count(&statuses[s], MPI_INT, &requestListSize);
+        if (requestListSize > 0)
+        {
+            const int* requestList = setup.requestListBuffer.data() + s * maxRequestListSize;
+            neighbor.shiftFlags    = requestList[0];
+            neighbor.atomIndices.resize(requestListSize - 1);
+            ga2la.findHome(gmx::constArrayRefFromArray(requestList + 1, requestListSize - 1),
+                           neighbor.atomIndices);
+            GMX_RELEASE_ASSERT(std::find(neighbor.atomIndices.begin(), neighbor.atomIndices.end(), -1)
+                                       == neighbor.atomIndices.end(),
+                               "Requested halo atoms should be our home atoms");
+        }
+    }
+
+#    if GMX_LIB_MPI
+    /* The persistent requests refer to the old buffers and neighbors */
+    freePersistentRequests(&setup.persistentX);
+    freePersistentRequests(&setup.persistentF);
+#    endif
+
+    setup.sendBuffer.resize(setNeighborBufferLayout(&setup.send));
+    setup.receiveBuffer.resize(setNeighborBufferLayout(&setup.receive));
+    setup.requests.resize(setup.send.size() + setup.receive.size());
+
+    setup.isSetUp = true;
+#else
+    GMX_UNUSED_VALUE(dd);
+#endif
+}
+
+void ddMoveXDirectStart(gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x)
+{
+#if GMX_MPI
+    DDDirectHaloSetup& setup = dd->comm->directHalo;
+    GMX_ASSERT(setup.isSetUp, "The direct halo exchange should be set up");
+    GMX_ASSERT(setup.numPendingRequests == 0, "No halo communication should be in flight");
+
+    const int numReceives = gmx::ssize(setup.receive);
+
+#    if GMX_LIB_MPI
+    /* With an MPI library we use persistent requests, which are set up
+     * once per local array after partitioning, to avoid the setup
+     * overhead every step.
+     */
+    MPI_Request* requests = persistentCoordinateRequests(dd, x.data());
+    MPI_Startall(numReceives, requests);
+#    else
+    /* Thread-MPI copies directly between the buffers of the ranks,
+     * so there is no gain from persistent requests.
+     */
+    MPI_Request* requests = setup.requests.data();
+    int          r        = 0;
+    for (const DDDirectHaloSetup::Neighbor& neighbor : setup.receive)
+    {
+        gmx::RVec* buffer = (neighbor.contiguousStart >= 0)
+                                    ? x.data() + neighbor.contiguousStart
+                                    : setup.receiveBuffer.data() + neighbor.bufferOffset;
+        MPI_Irecv(buffer, neighbor.atomIndices.size() * sizeof(rvec), MPI_BYTE, neighbor.rank,
+                  c_directHaloMpiTag, dd->mpi_comm_all, &requests[r++]);
+    }
+#    endif
+
+    /* Pack and send the data for each neighbor in turn, so the first
+     * messages are in flight while we pack the next ones.
+     */
+    int numRequests = numReceives;
+    for (const DDDirectHaloSetup::Neighbor& neighbor : setup.send)
+    {
+        gmx::RVec shift = { 0, 0, 0 };
+        for (int d = 0; d < dd->ndim; d++)
+        {
+            if (neighbor.shiftFlags & (1 << d))
+            {
+                rvec_inc(shift, box[dd->dim[d]]);
+            }
+        }
+
+        gmx::RVec* buffer = setup.sendBuffer.data() + neighbor.bufferOffset;
+        int        n      = 0;
+        for (int j : neighbor.atomIndices)
+        {
+            buffer[n++] = x[j] + shift;
+        }
+#    if GMX_LIB_MPI
+        MPI_Start(&requests[numRequests++]);
+#    else
+        MPI_Isend(buffer, n * sizeof(rvec), MPI_BYTE, neighbor.rank, c_directHaloMpiTag,
+                  dd->mpi_comm_all, &requests[numRequests++]);
+#    endif
+    }
+
+    setup.pendingRequests    = requests;
+    setup.numPendingRequests = numRequests;
+#else
+    GMX_UNUSED_VALUE(dd);
+    GMX_UNUSED_VALUE(box);
+    GMX_UNUSED_VALUE(x);
+#endif
+}
+
+void ddMoveXDirectFinish(gmx_domdec_t* dd, gmx::ArrayRef<gmx::RVec> x)
+{
+#if GMX_MPI
+    DDDirectHaloSetup& setup = dd->comm->directHalo;
+
+    MPI_Waitall(setup.numPendingRequests, setup.pendingRequests, MPI_STATUSES_IGNORE);
+    setup.numPendingRequests = 0;
+
+    for (const DDDirectHaloSetup::Neighbor& neighbor : setup.receive)
+    {
+        if (neighbor.contiguousStart < 0)
+        {
+            const gmx::RVec* buffer = setup.receiveBuffer.data() + neighbor.bufferOffset;
+            int              n      = 0;
+            for (int i : neighbor.atomIndices)
+            {
+                x[i] = buffer[n++];
+            }
+        }
+    }
+#else
+    GMX_UNUSED_VALUE(dd);
+    GMX_UNUSED_VALUE(x);
+#endif
+}
+
+void ddMoveFDirectStart(gmx_domdec_t* dd, gmx::ForceWithShiftForces* forceWithShiftForces)
+{
+#if GMX_MPI
+    DDDirectHaloSetup& setup = dd->comm->directHalo;
+    GMX_ASSERT(setup.isSetUp, "The direct halo exchange should be set up");
+    GMX_ASSERT(setup.numPendingRequests == 0, "No halo communication should be in flight");
+
+    gmx::ArrayRef<gmx::RVec> f = forceWithShiftForces->force();
+
+    /* The halo forces flow back along the paths the coordinates came from */
+    const int numReceives = gmx::ssize(setup.send);
+
+#    if GMX_LIB_MPI
+    MPI_Request* requests = persistentForceRequests(dd, f.data());
+    MPI_Startall(numReceives, requests);
+#    else
+    MPI_Request* requests = setup.requests.data();
+    int          r        = 0;
+    for (const DDDirectHaloSetup::Neighbor& neighbor : setup.send)
+    {
+        MPI_Irecv(setup.sendBuffer.data() + neighbor.bufferOffset,
+                  neighbor.atomIndices.size() * sizeof(rvec), MPI_BYTE, neighbor.rank,
+                  c_directHaloMpiTag, dd->mpi_comm_all, &requests[r++]);
+    }
+#    endif
+
+    int numRequests = numReceives;
+    for (const DDDirectHaloSetup::Neighbor& neighbor : setup.receive)
+    {
+        gmx::RVec* buffer;
+        if (neighbor.contiguousStart >= 0)
+        {
+            buffer = f.data() + neighbor.contiguousStart;
+        }
+        else
+        {
+            buffer = setup.receiveBuffer.data() + neighbor.bufferOffset;
+            int n  = 0;
+            for (int i : neighbor.atomIndices)
+            {
+                buffer[n++] = f[i];
+            }
+        }
+#    if GMX_LIB_MPI
+        MPI_Start(&requests[numRequests++]);
+#    else
+        MPI_Isend(buffer, neighbor.atomIndices.size() * sizeof(rvec), MPI_BYTE, neighbor.rank,
+                  c_directHaloMpiTag, dd->mpi_comm_all, &requests[numRequests++]);
+#    endif
+    }
+
+    setup.pendingRequests    = requests;
+    setup.numPendingRequests = numRequests;
+
+#    ifndef NDEBUG
+    /* The halo forces are sent from the force buffer itself and should
+     * therefore not be modified while the communication is in flight.
+     * Keep a copy so we can check this at finish.
+     */
+    setup.haloForcesAtStart.assign(
+            f.begin() + dd->comm->atomRanges.numHomeAtoms(),
+            f.begin() + dd->comm->atomRanges.end(DDAtomRanges::Type::Zones));
+#    endif
+#else
+    GMX_UNUSED_VALUE(dd);
+    GMX_UNUSED_VALUE(forceWithShiftForces);
+#endif
+}
+
+void ddMoveFDirectFinish(gmx_domdec_t* dd, gmx::ForceWithShiftForces* forceWithShiftForces)
+{
+#if GMX_MPI
+    DDDirectHaloSetup& setup = dd->comm->directHalo;
+
+    MPI_Waitall(setup.numPendingRequests, setup.pendingRequests, MPI_STATUSES_IGNORE);
+    setup.numPendingRequests = 0;
+
+    gmx::ArrayRef<gmx::RVec> f      = forceWithShiftForces->force();
+    gmx::ArrayRef<gmx::RVec> fshift = forceWithShiftForces->shiftForces();
+
+#    ifndef NDEBUG
+    const int numHomeAtoms = dd->comm->atomRanges.numHomeAtoms();
+    for (size_t i = 0; i < setup.haloForcesAtStart.size(); i++)
+    {
+        const gmx::RVec& fAtStart = setup.haloForcesAtStart[i];
+        GMX_ASSERT(f[numHomeAtoms + i][XX] == fAtStart[XX] && f[numHomeAtoms + i][YY] == fAtStart[YY]
+                           && f[numHomeAtoms + i][ZZ] == fAtStart[ZZ],
+                   "The halo forces should not change between starting and finishing the force "
+                   "halo communication");
+    }
+#    endif
+
+    const bool computeVirial = forceWithShiftForces->computeVirial();
+    for (const DDDirectHaloSetup::Neighbor& neighbor : setup.send)
+    {
+        const gmx::RVec* buffer = setup.sendBuffer.data() + neighbor.bufferOffset;
+        gmx::RVec        forceSum(0, 0, 0);
+        int              n = 0;
+        for (int j : neighbor.atomIndices)
+        {
+            f[j] += buffer[n];
+            forceSum += buffer[n];
+            n++;
+        }
+
+        /* With the pulse setup, the force is added to the shift force
+         * for each dimension along which the coordinates were shifted.
+         */
+        if (computeVirial)
+        {
+            for (int d = 0; d < dd->ndim; d++)
+            {
+                if (neighbor.shiftFlags & (1 << d))
+                {
+                    ivec vis        = { 0, 0, 0 };
+                    vis[dd->dim[d]] = 1;
+                    fshift[IVEC2IS(vis)] += forceSum;
+                }
+            }
+        }
+    }
+#else
+    GMX_UNUSED_VALUE(dd);
+    GMX_UNUSED_VALUE(forceWithShiftForces);
+#endif
+}
@@ -0,0 +1,126 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ *
+ * \brief Declares functions for communicating the halo with all
+ * neighboring domains in a single round.
+ *
+ * With the staggered eighth-shell zone setup, the halo is communicated
+ * in pulses that are serialized along the DD dimensions, since atoms
+ * received along one dimension are forwarded along the next dimensions.
+ * During the pulse setup, the origin of each halo atom, i.e. the cell
+ * offset of the domain the atom is a home atom of, is communicated along
+ * with the global atom indices. From this, the functions here derive
+ * which home atoms end up in the halo of which domain, using a single
+ * round of communication with the neighbor domains. The halo coordinates and forces
+ * can then be communicated directly with all neighbor domains using
+ * concurrent non-blocking communication, which reduces the number of
+ * latency-bound sequential communication steps from up to six to one.
+ *
+ * \ingroup module_domdec
+ */
+#ifndef GMX_DOMDEC_DIRECTHALO_H
+#define GMX_DOMDEC_DIRECTHALO_H
+
+#include "gromacs/math/vectypes.h"
+
+struct gmx_domdec_t;
+
+namespace gmx
+{
+template<typename>
+class ArrayRef;
+class ForceWithShiftForces;
+} // namespace gmx
+
+//! The number of bits used per DD dimension for the cell offset in a packed halo atom origin
+static constexpr int c_directHaloOriginBitsPerDim = 10;
+
+/*! \brief Returns the origin of an atom after it has been communicated one cell along DD dimension index \p dimIndex
+ *
+ * The origin of an atom is the cell offset along each DD dimension of
+ * the domain the atom is a home atom of, packed in a single integer.
+ * Home atoms have origin 0.
+ */
+static inline int ddDirectHaloOriginAfterPulse(int origin, int dimIndex)
+{
+    return origin + (1 << (dimIndex * c_directHaloOriginBitsPerDim));
+}
+
+//! Returns the cell offset along DD dimension index \p dimIndex of the packed atom origin \p origin
+static inline int ddDirectHaloOriginOffset(int origin, int dimIndex)
+{
+    return (origin >> (dimIndex * c_directHaloOriginBitsPerDim))
+           & ((1 << c_directHaloOriginBitsPerDim) - 1);
+}
+
+/*! \brief Sets up the single-round halo exchange from the pulse communication setup
+ *
+ * Screw PBC is not supported, as that requires rotation of coordinates
+ * and forces in between pulses.
+ * Should be called after the pulse communication has been set up
+ * at each partitioning, which sets the halo atom origins, and after
+ * the global to local indices of the home atoms have been set.
+ * This call involves a single round of communication with
+ * the neighboring domains.
+ */
+void setupDirectHaloExchange(gmx_domdec_t* dd);
+
+/*! \brief Starts communicating the halo coordinates with all neighbors in a single round
+ *
+ * The halo coordinates in \p x are only valid after ddMoveXDirectFinish()
+ * has been called, \p x should not be modified in between.
+ */
+void ddMoveXDirectStart(gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x);
+
+//! Waits for the communication started with ddMoveXDirectStart() to complete
+void ddMoveXDirectFinish(gmx_domdec_t* dd, gmx::ArrayRef<gmx::RVec> x);
+
+/*! \brief Starts communicating the halo forces with all neighbors in a single round
+ *
+ * The forces on the halo atoms should not be modified until
+ * ddMoveFDirectFinish() has been called. The forces on home atoms
+ * can be modified in between.
+ */
+void ddMoveFDirectStart(gmx_domdec_t* dd, gmx::ForceWithShiftForces* forceWithShiftForces);
+
+/*! \brief Waits for the communication started with ddMoveFDirectStart() to complete
+ *
+ * Adds the received halo forces to the home atom forces and,
+ * when computing the virial, updates the shift forces.
+ */
+void ddMoveFDirectFinish(gmx_domdec_t* dd, gmx::ForceWithShiftForces* forceWithShiftForces);
+
+#endif
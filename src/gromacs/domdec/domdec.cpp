@@ -106,6 +106,7 @@
 #include "atomdistribution.h"
 #include "box.h"
 #include "cellsizes.h"
+#include "directhalo.h"
 #include "distribute.h"
 #include "domdec_constraints.h"
 #include "domdec_internal.h"
@@ -152,7 +153,7 @@ static void ddindex2xyz(const ivec nc, int ind, ivec xyz)
     xyz[ZZ] = ind % nc[ZZ];
 }
 
-static int ddcoord2ddnodeid(gmx_domdec_t* dd, ivec c)
+int ddcoord2ddnodeid(gmx_domdec_t* dd, const ivec c)
 {
     int ddnodeid = -1;
 
@@ -165,7 +166,7 @@ static int ddcoord2ddnodeid(gmx_domdec_t* dd, ivec c)
     else if (cartSetup.bCartesianPP)
     {
 #if GMX_MPI
-        MPI_Cart_rank(dd->mpi_comm_all, c, &ddnodeid);
+        MPI_Cart_rank(dd->mpi_comm_all, const_cast<int*>(c), &ddnodeid);
 #endif
     }
     else
@@ -261,6 +262,16 @@ void dd_move_x(gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, g
 {
     wallcycle_start(wcycle, ewcMOVEX);
 
+    if (dd->comm->ddSettings.useDirectHaloExchange)
+    {
+        ddMoveXDirectStart(dd, box, x);
+        ddMoveXDirectFinish(dd, x);
+
+        wallcycle_stop(wcycle, ewcMOVEX);
+
+        return;
+    }
+
     int                    nzone, nat_tot;
     gmx_domdec_comm_t*     comm;
     gmx_domdec_comm_dim_t* cd;
@@ -355,10 +366,55 @@ void dd_move_x(gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, g
     wallcycle_stop(wcycle, ewcMOVEX);
 }
 
+bool dd_haloExchangeCanOverlapCompute(const gmx_domdec_t& dd)
+{
+    return dd.comm->ddSettings.useDirectHaloExchange;
+}
+
+void dd_move_x_start(gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle)
+{
+    if (!dd_haloExchangeCanOverlapCompute(*dd))
+    {
+        dd_move_x(dd, box, x, wcycle);
+
+        return;
+    }
+
+    wallcycle_start(wcycle, ewcMOVEX);
+
+    ddMoveXDirectStart(dd, box, x);
+
+    wallcycle_stop(wcycle, ewcMOVEX);
+}
+
+void dd_move_x_finish(gmx_domdec_t* dd, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle)
+{
+    if (!dd_haloExchangeCanOverlapCompute(*dd))
+    {
+        return;
+    }
+
+    wallcycle_start_nocount(wcycle, ewcMOVEX);
+
+    ddMoveXDirectFinish(dd, x);
+
+    wallcycle_stop(wcycle, ewcMOVEX);
+}
+
 void dd_move_f(gmx_domdec_t* dd, gmx::ForceWithShiftForces* forceWithShiftForces, gmx_wallcycle* wcycle)
 {
     wallcycle_start(wcycle, ewcMOVEF);
 
+    if (dd->comm->ddSettings.useDirectHaloExchange)
+    {
+        ddMoveFDirectStart(dd, forceWithShiftForces);
+        ddMoveFDirectFinish(dd, forceWithShiftForces);
+
+        wallcycle_stop(wcycle, ewcMOVEF);
+
+        return;
+    }
+
     gmx::ArrayRef<gmx::RVec> f      = forceWithShiftForces->force();
     gmx::ArrayRef<gmx::RVec> fshift = forceWithShiftForces->shiftForces();
 
@@ -464,6 +520,36 @@ void dd_move_f(gmx_domdec_t* dd, gmx::ForceWithShiftForces* forceWithShiftForces
     wallcycle_stop(wcycle, ewcMOVEF);
 }
 
+void dd_move_f_start(gmx_domdec_t* dd, gmx::ForceWithShiftForces* forceWithShiftForces, gmx_wallcycle* wcycle)
+{
+    if (!dd_haloExchangeCanOverlapCompute(*dd))
+    {
+        dd_move_f(dd, forceWithShiftForces, wcycle);
+
+        return;
+    }
+
+    wallcycle_start(wcycle, ewcMOVEF);
+
+    ddMoveFDirectStart(dd, forceWithShiftForces);
+
+    wallcycle_stop(wcycle, ewcMOVEF);
+}
+
+void dd_move_f_finish(gmx_domdec_t* dd, gmx::ForceWithShiftForces* forceWithShiftForces, gmx_wallcycle* wcycle)
+{
+    if (!dd_haloExchangeCanOverlapCompute(*dd))
+    {
+        return;
+    }
+
+    wallcycle_start_nocount(wcycle, ewcMOVEF);
+
+    ddMoveFDirectFinish(dd, forceWithShiftForces);
+
+    wallcycle_stop(wcycle, ewcMOVEF);
+}
+
 /* Convenience function for extracting a real buffer from an rvec buffer
  *
  * To reduce the number of temporary communication buffers and avoid
@@ -2440,6 +2526,15 @@ static void set_dd_limits(const gmx::MDLogger& mdlog,
         comm->slb_frac[XX] = get_slb_frac(mdlog, "x", dd->numCells[XX], options.cellSizeX);
         comm->slb_frac[YY] = get_slb_frac(mdlog, "y", dd->numCells[YY], options.cellSizeY);
         comm->slb_frac[ZZ] = get_slb_frac(mdlog, "z", dd->numCells[ZZ], options.cellSizeZ);
+        for (int dim = 0; dim < DIM; dim++)
+        {
+            const std::vector<real>& fractions = ddGridSetup.atomWeightedCellFractions[dim];
+            if (comm->slb_frac[dim] == nullptr && !fractions.empty())
+            {
+                snew(comm->slb_frac[dim], fractions.size());
+                std::copy(fractions.begin(), fractions.end(), comm->slb_frac[dim]);
+            }
+        }
     }
 
     /* Set the multi-body cut-off and cellsize limit for DLB */
@@ -2865,8 +2960,10 @@ static DDSettings getDDSettings(const gmx::MDLogger&     mdlog,
 
     ddSettings.useSendRecv2        = (dd_getenv(mdlog, "GMX_DD_USE_SENDRECV2", 0) != 0);
     ddSettings.dlb_scale_lim       = dd_getenv(mdlog, "GMX_DLB_MAX_BOX_SCALING", 10);
+    ddSettings.useDlbCostModel     = (dd_getenv(mdlog, "GMX_DLB_COST_MODEL", 0) != 0);
     ddSettings.useDDOrderZYX       = bool(dd_getenv(mdlog, "GMX_DD_ORDER_ZYX", 0));
     ddSettings.useCartesianReorder = bool(dd_getenv(mdlog, "GMX_NO_CART_REORDER", 1));
+    ddSettings.useAtomWeightedGrid = (dd_getenv(mdlog, "GMX_DD_ATOM_WEIGHTED_GRID", 0) != 0);
     ddSettings.eFlop               = dd_getenv(mdlog, "GMX_DLB_BASED_ON_FLOPS", 0);
     const int recload              = dd_getenv(mdlog, "GMX_DD_RECORD_LOAD", 1);
     ddSettings.nstDDDump           = dd_getenv(mdlog, "GMX_DD_NST_DUMP", 0);
@@ -2882,6 +2979,35 @@ static DDSettings getDDSettings(const gmx::MDLogger&     mdlog,
                         "communication");
     }
 
+    ddSettings.useDirectHaloExchange = (dd_getenv(mdlog, "GMX_DD_DIRECT_HALO", 0) != 0);
+    if (ddSettings.useDirectHaloExchange)
+    {
+        if (ir.pbcType == PbcType::Screw)
+        {
+            GMX_LOG(mdlog.info)
+                    .appendText(
+                            "Single-round halo communication is not supported with screw PBC, "
+                            "will communicate the halo in pulses");
+            ddSettings.useDirectHaloExchange = false;
+        }
+        else
+        {
+            GMX_LOG(mdlog.info)
+                    .appendText(
+                            "Will communicate the halo with all neighbor domains in a single "
+                            "round of non-blocking communication");
+        }
+    }
+
+    ddSettings.useIncrementalLocalTopology = (dd_getenv(mdlog, "GMX_DD_INCREMENTAL_TOPOLOGY", 0) != 0);
+    if (ddSettings.useIncrementalLocalTopology)
+    {
+        GMX_LOG(mdlog.info)
+                .appendText(
+                        "Will keep the bonded interactions between home atoms that stay at home "
+                        "when updating the local topology after repartitioning");
+    }
+
     if (ddSettings.eFlop)
     {
         GMX_LOG(mdlog.info).appendText("Will load balance based on FLOP count");
@@ -216,6 +216,44 @@ void dd_move_x(struct gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVe
  */
 void dd_move_f(struct gmx_domdec_t* dd, gmx::ForceWithShiftForces* forceWithShiftForces, gmx_wallcycle* wcycle);
 
+/*! \brief Returns whether the halo exchange can be overlapped with computation
+ *
+ * When true, dd_move_x_start() and dd_move_f_start() return with
+ * the communication in flight. Otherwise they complete the exchange
+ * and the corresponding finish calls are no-ops.
+ */
+bool dd_haloExchangeCanOverlapCompute(const gmx_domdec_t& dd);
+
+/*! \brief Start communicating the halo coordinates
+ *
+ * The halo coordinates are only valid after dd_move_x_finish() has been called.
+ * The home coordinates should not be modified in between.
+ */
+void dd_move_x_start(struct gmx_domdec_t*     dd,
+                     const matrix             box,
+                     gmx::ArrayRef<gmx::RVec> x,
+                     gmx_wallcycle*           wcycle);
+
+/*! \brief Complete the communication started with dd_move_x_start() */
+void dd_move_x_finish(struct gmx_domdec_t* dd, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle);
+
+/*! \brief Start sending the halo forces to the neighboring cells
+ *
+ * The halo forces should not be modified until dd_move_f_finish() has been called.
+ * The forces on home atoms can be modified in between.
+ */
+void dd_move_f_start(struct gmx_domdec_t*       dd,
+                     gmx::ForceWithShiftForces* forceWithShiftForces,
+                     gmx_wallcycle*             wcycle);
+
+/*! \brief Complete the force communication started with dd_move_f_start()
+ *
+ * Sums the received halo forces into the home atom forces.
+ */
+void dd_move_f_finish(struct gmx_domdec_t*       dd,
+                      gmx::ForceWithShiftForces* forceWithShiftForces,
+                      gmx_wallcycle*             wcycle);
+
 /*! \brief Communicate a real for each atom to the neighboring cells. */
 void dd_atom_spread_real(struct gmx_domdec_t* dd, real v[]);
 
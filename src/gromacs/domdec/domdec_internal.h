@@ -94,6 +94,92 @@ struct gmx_domdec_comm_dim_t
     bool receiveInPlace = false;
 };
 
+/*! \brief Setup for halo communication with all neighbor domains in a single round
+ *
+ * Instead of forwarding halo data along the DD dimensions in pulses,
+ * each rank sends its home atoms directly to every domain that has
+ * them in its halo, using concurrent non-blocking communication.
+ * The setup is derived from the pulse setup at each partitioning,
+ * during which the cell offset of the home domain of each halo atom
+ * is communicated along with the global atom indices.
+ */
+struct DDDirectHaloSetup
+{
+    //! The atoms to communicate with a single neighbor rank
+    struct Neighbor
+    {
+        //! The rank of the neighbor
+        int rank = -1;
+        //! When sending, bit d tells whether to shift by the box vector along DD dim index d
+        int shiftFlags = 0;
+        //! The local atom indices to send from or receive into
+        std::vector<int> atomIndices;
+        //! When the atom indices are consecutive, the first index, otherwise -1
+        int contiguousStart = -1;
+        //! The offset of the data for this neighbor in the communication buffer
+        int bufferOffset = 0;
+    };
+
+    //! Persistent communication requests, set up for a local data array
+    struct PersistentRequests
+    {
+        //! The local array the requests communicate from and to
+        const gmx::RVec* data = nullptr;
+        //! The receive requests followed by the send requests
+        std::vector<MPI_Request> requests;
+    };
+
+    //! The maximum number of local arrays to keep persistent requests for, per communication direction
+    static constexpr int c_maxNumPersistentArrays = 4;
+
+    DDDirectHaloSetup() = default;
+    //! Frees the persistent requests
+    ~DDDirectHaloSetup();
+    //! The persistent requests should not be copied
+    DDDirectHaloSetup(const DDDirectHaloSetup&) = delete;
+    //! The persistent requests should not be copied
+    DDDirectHaloSetup& operator=(const DDDirectHaloSetup&) = delete;
+
+    //! Whether the setup is valid for the current partitioning
+    bool isSetUp = false;
+    //! For each local atom the packed cell offsets of its home domain, set up with the pulses
+    std::vector<int> atomOrigins;
+    //! Buffer for the global indices and origins communicated during the pulse setup
+    std::vector<int> originSetupBuffer;
+    //! Buffer for the received origins when not receiving in place during the pulse setup
+    std::vector<int> originMergeBuffer;
+    //! Buffer for receiving the lists of atoms requested by neighbors
+    std::vector<int> requestListBuffer;
+    //! Copy of the halo forces when starting the force communication, only used in debug builds
+    std::vector<gmx::RVec> haloForcesAtStart;
+    //! The neighbors we send home atoms to
+    std::vector<Neighbor> send;
+    //! The neighbors we receive halo atoms from
+    std::vector<Neighbor> receive;
+    //! Buffer for packing the data to send to all neighbors
+    std::vector<gmx::RVec> sendBuffer;
+    //! Buffer for receiving the data from all neighbors
+    std::vector<gmx::RVec> receiveBuffer;
+    //! Requests for the non-blocking communication
+    std::vector<MPI_Request> requests;
+    /*! \brief Persistent requests for the coordinate communication, one entry per local array
+     *
+     * Only used with an MPI library. Multiple entries are needed since,
+     * for instance, energy minimization alternates between state arrays.
+     */
+    std::vector<PersistentRequests> persistentX;
+    /*! \brief Persistent requests for the force communication, one entry per local array
+     *
+     * Only used with an MPI library. Multiple entries are needed since,
+     * with multiple time stepping, forces are communicated from two buffers.
+     */
+    std::vector<PersistentRequests> persistentF;
+    //! The requests in flight
+    MPI_Request* pendingRequests = nullptr;
+    //! The number of requests in flight
+    int numPendingRequests = 0;
+};
+
 /*! \brief Load balancing data along a dim used on the master rank of that dim */
 struct RowMaster
 {
@@ -467,9 +553,17 @@ struct DDSettings
     //! Use MPI_Sendrecv communication instead of non-blocking calls
     bool useSendRecv2 = false;
 
+    //! Communicate the halo with all neighbors in a single round instead of in pulses
+    bool useDirectHaloExchange = false;
+
+    //! Update the local topology incrementally after repartitioning
+    bool useIncrementalLocalTopology = false;
+
     /* Information for managing the dynamic load balancing */
     //! Maximum DLB scaling per load balancing step in percent
     int dlb_scale_lim = 0;
+    //! Set the DLB cell boundaries using a cost model of the measured load
+    bool useDlbCostModel = false;
     //! Flop counter (0=no,1=yes,2=with (eFlop-1)*5% noise
     int eFlop = 0;
 
@@ -479,6 +573,9 @@ struct DDSettings
     //! Whether to use MPI Cartesian reordering of communicators, when supported (almost never)
     bool useCartesianReorder = true;
 
+    //! Whether to use atom-weighted static cell sizes when DLB is disabled
+    bool useAtomWeightedGrid = false;
+
     //! Whether we should record the load
     bool recordLoad = false;
 
@@ -633,6 +730,9 @@ struct gmx_domdec_comm_t // NOLINT (clang-analyzer-optin.performance.Padding)
      * would violate this restriction. */
     int maxpulse = 0;
 
+    /** The setup for single-round halo communication, used with useDirectHaloExchange */
+    DDDirectHaloSetup directHalo;
+
     /** Which cg distribution is stored on the master node,
      *  stored as DD partitioning call count.
      */
@@ -773,6 +873,9 @@ static inline int dd_index(const ivec numDomains, const ivec domainCoordinates)
            + domainCoordinates[ZZ];
 };
 
+/*! \brief Returns the DD rank of the domain with DD cell coordinates \p c */
+int ddcoord2ddnodeid(gmx_domdec_t* dd, const ivec c);
+
 /*! Returns the size of the buffer to hold fractional cell boundaries for DD dimension index dimIndex */
 static inline int ddCellFractionBufferSize(const gmx_domdec_t* dd, int dimIndex)
 {
@@ -53,6 +53,10 @@
 #include <cmath>
 #include <cstdio>
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include "gromacs/domdec/domdec.h"
 #include "gromacs/domdec/domdec_struct.h"
 #include "gromacs/domdec/options.h"
@@ -888,6 +892,70 @@ static int set_dd_dim(const gmx::IVec& numDDCells, const DDSettings& ddSettings,
     return ndim;
 }
 
+std::vector<real> atomWeightedCellFractions(int                            dim,
+                                            int                            numCells,
+                                            const DDSystemInfo&            systemInfo,
+                                            const gmx_ddbox_t&             ddbox,
+                                            gmx::ArrayRef<const gmx::RVec> xGlobal)
+{
+    /* Atom positions along a triclinic dimension depend on the other
+     * dimensions, for simplicity we only use uniform cells there.
+     */
+    if (numCells == 1 || ddbox.tric_dir[dim] || xGlobal.empty())
+    {
+        return {};
+    }
+
+    const real cellSizeMin = std::max(systemInfo.cellsizeLimit, systemInfo.cutoff) * DD_CELL_MARGIN;
+    const real fractionMin = cellSizeMin / (ddbox.box_size[dim] * ddbox.skew_fac[dim]);
+    if (numCells * fractionMin >= 1)
+    {
+        return {};
+    }
+
+    std::vector<real> position;
+    position.reserve(xGlobal.size());
+    for (const gmx::RVec& x : xGlobal)
+    {
+        real f = (x[dim] - ddbox.box0[dim]) / ddbox.box_size[dim];
+        if (dim < ddbox.npbcdim)
+        {
+            f -= std::floor(f);
+        }
+        position.push_back(std::clamp(f, real(0), real(1)));
+    }
+    std::sort(position.begin(), position.end());
+
+    std::vector<real> boundary(numCells + 1);
+    boundary[0]        = 0;
+    boundary[numCells] = 1;
+    for (int i = 1; i < numCells; i++)
+    {
+        boundary[i] = position[(i * position.size()) / numCells];
+    }
+
+    /* Blend with the uniform grid until all cells are large enough */
+    constexpr int     c_numBlendSteps = 8;
+    std::vector<real> fractions(numCells);
+    for (int step = 0; step <= c_numBlendSteps; step++)
+    {
+        const real uniformWeight = step / real(c_numBlendSteps);
+        bool       cellsAreValid = true;
+        for (int i = 0; i < numCells; i++)
+        {
+            fractions[i] = (1 - uniformWeight) * (boundary[i + 1] - boundary[i])
+                           + uniformWeight / numCells;
+            cellsAreValid = cellsAreValid && (fractions[i] >= fractionMin);
+        }
+        if (cellsAreValid)
+        {
+            return step < c_numBlendSteps ? fractions : std::vector<real>();
+        }
+    }
+
+    return {};
+}
+
 DDGridSetup getDDGridSetup(const gmx::MDLogger&           mdlog,
                            DDRole                         ddRole,
                            MPI_Comm                       communicator,
@@ -936,5 +1004,45 @@ DDGridSetup getDDGridSetup(const gmx::MDLogger&           mdlog,
     ddGridSetup.numDomains[ZZ]  = numDomains[ZZ];
     ddGridSetup.numDDDimensions = set_dd_dim(numDomains, ddSettings, &ddGridSetup.ddDimensions);
 
+    /* Static atom-weighted cells are only used without DLB and user supplied cell sizes */
+    if (ddSettings.useAtomWeightedGrid && isDlbDisabled(ddSettings.initialDlbState)
+        && options.cellSizeX == nullptr && options.cellSizeY == nullptr && options.cellSizeZ == nullptr)
+    {
+        for (int d = 0; d < ddGridSetup.numDDDimensions; d++)
+        {
+            const int         dim       = ddGridSetup.ddDimensions[d];
+            std::vector<real>& fractions = ddGridSetup.atomWeightedCellFractions[dim];
+            if (ddRole == DDRole::Master)
+            {
+                fractions = atomWeightedCellFractions(dim, numDomains[dim], systemInfo, *ddbox, xGlobal);
+            }
+            int numFractions = fractions.size();
+            gmx_bcast(sizeof(numFractions), &numFractions, communicator);
+            fractions.resize(numFractions);
+            if (numFractions > 0)
+            {
+                gmx_bcast(numFractions * sizeof(real), fractions.data(), communicator);
+            }
+        }
+        if (ddRole == DDRole::Master)
+        {
+            std::string relativeCellSizes;
+            for (int dim = 0; dim < DIM; dim++)
+            {
+                for (const real fraction : ddGridSetup.atomWeightedCellFractions[dim])
+                {
+                    relativeCellSizes += gmx::formatString(" %5.3f", fraction);
+                }
+                if (!ddGridSetup.atomWeightedCellFractions[dim].empty())
+                {
+                    relativeCellSizes += gmx::formatString(" (%c)", dim2char(dim));
+                }
+            }
+            GMX_LOG(mdlog.info)
+                    .appendTextFormatted("Atom-weighted relative cell sizes:%s",
+                                         relativeCellSizes.empty() ? " uniform" : relativeCellSizes.c_str());
+        }
+    }
+
     return ddGridSetup;
 }
@@ -42,6 +42,9 @@
 #ifndef GMX_DOMDEC_DOMDEC_SETUP_H
 #define GMX_DOMDEC_DOMDEC_SETUP_H
 
+#include <array>
+#include <vector>
+
 #include "gromacs/math/vec.h"
 #include "gromacs/utility/gmxmpi.h"
 
@@ -80,6 +83,8 @@ struct DDGridSetup
     int numDDDimensions = 0;
     //! The domain decomposition dimensions, the first numDDDimensions entries are used
     ivec ddDimensions = { -1, -1, -1 };
+    //! Atom-weighted relative cell sizes along each dimension, empty for uniform cells
+    std::array<std::vector<real>, DIM> atomWeightedCellFractions;
 };
 
 /*! \brief Checks that requests for PP and PME ranks honor basic expectations
@@ -99,11 +104,34 @@ real getDDGridSetupCellSizeLimit(const gmx::MDLogger& mdlog,
                                  const t_inputrec&    ir,
                                  real                 systemInfoCellSizeLimit);
 
+/*! \brief Returns atom-weighted relative cell sizes along dimension \p dim
+ *
+ * The cell boundaries are placed at the quantiles of the atom coordinates
+ * along \p dim only, so each cell along \p dim holds the same number
+ * of atoms. Each decomposition dimension is treated independently
+ * using the marginal distribution of the atoms along that dimension.
+ * When some cells would be smaller than the minimum cell size, the
+ * sizes are blended toward uniform cells in steps of 1/8 until all
+ * cells are large enough. Returns an empty vector when uniform cells
+ * should be used: with a single cell, along triclinic dimensions, or
+ * when the blend only succeeds for fully uniform cells.
+ *
+ * The result is only used as static cell sizes, i.e. with dynamic
+ * load balancing turned off.
+ */
+std::vector<real> atomWeightedCellFractions(int                            dim,
+                                            int                            numCells,
+                                            const DDSystemInfo&            systemInfo,
+                                            const gmx_ddbox_t&             ddbox,
+                                            gmx::ArrayRef<const gmx::RVec> xGlobal);
+
 /*! \brief Determines the DD grid setup
  *
  * Either implements settings required by the user, or otherwise
  * chooses estimated optimal number of separate PME ranks and DD grid
  * cell setup, DD cell size limits, and the initial ddbox.
+ * With DDSettings::useAtomWeightedGrid and DLB turned off, the relative
+ * cell sizes are set by atomWeightedCellFractions().
  */
 DDGridSetup getDDGridSetup(const gmx::MDLogger&           mdlog,
                            DDRole                         ddRole,
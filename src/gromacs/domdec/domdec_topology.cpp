@@ -128,6 +128,31 @@ struct thread_work_t
     int                            excl_count = 0;     /**< The total exclusion count for \p excl */
 };
 
+/*! \brief Data for updating the local topology incrementally after repartitioning
+ *
+ * Bonded interactions that only involve home atoms are always assigned
+ * to the home rank. When all atoms of such interactions are still home
+ * atoms after repartitioning, the interactions can be kept and only need
+ * to be renumbered, which avoids looking them up in the reverse topology.
+ */
+struct IncrementalLocalTopology
+{
+    //! The local topology the home atom data refers to, nullptr when there is no valid data
+    const gmx_localtop_t* localTopology = nullptr;
+    //! The global atom indices of the home atoms at the last update of the local topology
+    std::vector<int> homeAtomGlobalIndices;
+    //! Whether all interactions linked to a home atom were assigned and only involve home atoms
+    std::vector<char> homeAtomIsSelfContained;
+    //! Work array: the new local index for each previous home atom, -1 when no longer home
+    std::vector<int> oldToNewHomeIndex;
+    //! Work array: whether we keep the interactions of a previous home atom
+    std::vector<char> keepOldHomeAtom;
+    //! Whether the interactions linked to a home atom are kept, indexed by the new local index
+    std::vector<char> homeAtomIsKept;
+    //! The kept interactions, renumbered to the new local atom indices
+    InteractionLists keptInteractions;
+};
+
 /*! \brief Struct for the reverse topology: links bonded interactions to atomsx */
 struct gmx_reverse_top_t
 {
@@ -154,6 +179,9 @@ struct gmx_reverse_top_t
     //! \brief Intermolecular reverse ilist
     reverse_ilist_t ril_intermol;
 
+    //! \brief Data for incremental updates of the local topology
+    IncrementalLocalTopology incremental;
+
     /* Work data structures for multi-threading */
     //! \brief Thread work array for local topology generation
     std::vector<thread_work_t> th_work;
@@ -1044,6 +1072,10 @@ static void combine_idef(InteractionDefinitions* dest, gmx::ArrayRef<const threa
 }
 
 /*! \brief Check and when available assign bonded interactions for local atom i
+ *
+ * When \p isSelfContained is not nullptr, it is set to false when not all
+ * interactions linked to atom i are assigned to home atoms only or when
+ * interactions are present that can not be kept for incremental updates.
  */
 static inline void check_assign_interactions_atom(int                       i,
                                                   int                       i_gl,
@@ -1068,7 +1100,8 @@ static inline void check_assign_interactions_atom(int                       i,
                                                   InteractionDefinitions*   idef,
                                                   int                       iz,
                                                   gmx_bool                  bBCheck,
-                                                  int*                      nbonded_local)
+                                                  int*                      nbonded_local,
+                                                  bool*                     isSelfContained)
 {
     gmx::ArrayRef<const DDPairInteractionRanges> iZones = zones->iZones;
 
@@ -1088,6 +1121,10 @@ static inline void check_assign_interactions_atom(int                       i,
             {
                 add_vsite(*dd->ga2la, index, rtil, ftype, nral, TRUE, i, i_gl, i_mol, iatoms.data(), idef);
             }
+            if (isSelfContained)
+            {
+                *isSelfContained = false;
+            }
         }
         else
         {
@@ -1247,6 +1284,18 @@ static inline void check_assign_interactions_atom(int                       i,
                     (*nbonded_local)++;
                 }
             }
+            if (isSelfContained && *isSelfContained)
+            {
+                /* Position restraints have per interaction parameters,
+                 * so we do not keep them.
+                 */
+                bool involvesOnlyHomeAtoms = (bUse && ftype != F_POSRES && ftype != F_FBPOSRES);
+                for (int k = 1; k <= nral && involvesOnlyHomeAtoms; k++)
+                {
+                    involvesOnlyHomeAtoms = (tiatoms[k] < dd->comm->atomRanges.numHomeAtoms());
+                }
+                *isSelfContained = involvesOnlyHomeAtoms;
+            }
         }
         j += 1 + nral_rt(ftype);
     }
@@ -1256,6 +1305,10 @@ static inline void check_assign_interactions_atom(int                       i,
  *
  * With thread parallelizing each thread acts on a different atom range:
  * at_start to at_end.
+ *
+ * Home atoms that are marked in \p homeAtomIsKept are skipped, their
+ * interactions are added from the previous local topology instead.
+ * When \p homeAtomIsSelfContained is not empty, it is set for the home atoms.
  */
 static int make_bondeds_zone(gmx_domdec_t*                      dd,
                              const gmx_domdec_zones_t*          zones,
@@ -1269,7 +1322,9 @@ static int make_bondeds_zone(gmx_domdec_t*                      dd,
                              const t_iparams*                   ip_in,
                              InteractionDefinitions*            idef,
                              int                                izone,
-                             const gmx::Range<int>&             atomRange)
+                             const gmx::Range<int>&             atomRange,
+                             gmx::ArrayRef<const char>          homeAtomIsKept,
+                             gmx::ArrayRef<char>                homeAtomIsSelfContained)
 {
     int                mb, mt, mol, i_mol;
     gmx_bool           bBCheck;
@@ -1282,8 +1337,18 @@ static int make_bondeds_zone(gmx_domdec_t*                      dd,
 
     nbonded_local = 0;
 
+    const bool trackSelfContained = (izone == 0 && !homeAtomIsSelfContained.empty());
+
     for (int i : atomRange)
     {
+        if (izone == 0 && !homeAtomIsKept.empty() && homeAtomIsKept[i])
+        {
+            continue;
+        }
+
+        bool  isSelfContained    = true;
+        bool* isSelfContainedPtr = (trackSelfContained ? &isSelfContained : nullptr);
+
         /* Get the global atom number */
         const int i_gl = dd->globalAtomIndices[i];
         global_atomnr_to_moltype_ind(rt, i_gl, &mb, &mt, &mol, &i_mol);
@@ -1294,7 +1359,8 @@ static int make_bondeds_zone(gmx_domdec_t*                      dd,
         check_assign_interactions_atom(i, i_gl, mol, i_mol, rt->ril_mt[mt].numAtomsInMolecule,
                                        index, rtil, FALSE, index[i_mol], index[i_mol + 1], dd,
                                        zones, &molb[mb], bRCheckMB, rcheck, bRCheck2B, rc2,
-                                       pbc_null, cg_cm, ip_in, idef, izone, bBCheck, &nbonded_local);
+                                       pbc_null, cg_cm, ip_in, idef, izone, bBCheck,
+                                       &nbonded_local, isSelfContainedPtr);
 
 
         if (rt->bIntermolecularInteractions)
@@ -1306,7 +1372,13 @@ static int make_bondeds_zone(gmx_domdec_t*                      dd,
             check_assign_interactions_atom(i, i_gl, mol, i_mol, rt->ril_mt[mt].numAtomsInMolecule,
                                            index, rtil, TRUE, index[i_gl], index[i_gl + 1], dd, zones,
                                            &molb[mb], bRCheckMB, rcheck, bRCheck2B, rc2, pbc_null,
-                                           cg_cm, ip_in, idef, izone, bBCheck, &nbonded_local);
+                                           cg_cm, ip_in, idef, izone, bBCheck, &nbonded_local,
+                                           isSelfContainedPtr);
+        }
+
+        if (trackSelfContained)
+        {
+            homeAtomIsSelfContained[i] = static_cast<char>(isSelfContained);
         }
     }
 
@@ -1384,20 +1456,176 @@ static void make_exclusions_zone(gmx_domdec_t*                     dd,
             "The number of exclusion list should match the number of atoms in the range");
 }
 
+/*! \brief Returns whether interactions of type \p ftype can be kept in incremental local topology updates
+ *
+ * Virtual sites can involve non-local constructing atoms, position restraints
+ * have parameters per interaction and constraints that are not in the reverse
+ * topology are assigned by the constraint code.
+ */
+static bool canKeepInteractionType(const gmx_reverse_top_t& rt, int ftype)
+{
+    return !(interaction_function[ftype].flags & IF_VSITE) && ftype != F_POSRES
+           && ftype != F_FBPOSRES && ftype != F_CONSTRNC && (ftype != F_CONSTR || rt.bConstr)
+           && (ftype != F_SETTLE || rt.bSettle);
+}
+
+/*! \brief The maximum fraction of home atoms that can have changed for an incremental update */
+static constexpr double c_maxChangedHomeAtomFractionForIncrementalUpdate = 0.25;
+
+/*! \brief Extracts the interactions of home atoms that can be kept from the previous local topology
+ *
+ * Interactions linked to a previous home atom are kept when the atom was
+ * self-contained and all atoms involved in its interactions are still home
+ * atoms. The kept interactions are renumbered to the new local atom indices
+ * and stored in \p incremental, the new home atoms whose interactions are kept
+ * are marked in \p incremental->homeAtomIsKept.
+ * No interactions are kept when \p ltop is not the local topology that
+ * was updated last or when too many home atoms changed.
+ */
+static void extractKeptHomeInteractions(const gmx_domdec_t&       dd,
+                                        const gmx_reverse_top_t&  rt,
+                                        const gmx_localtop_t&     ltop,
+                                        IncrementalLocalTopology* incremental)
+{
+    const int numHomeAtoms    = dd.comm->atomRanges.numHomeAtoms();
+    const int oldNumHomeAtoms = gmx::ssize(incremental->homeAtomGlobalIndices);
+
+    incremental->homeAtomIsKept.assign(numHomeAtoms, 0);
+    for (InteractionList& ilist : incremental->keptInteractions)
+    {
+        ilist.clear();
+    }
+
+    if (incremental->localTopology != &ltop)
+    {
+        return;
+    }
+
+    const InteractionDefinitions& idef = ltop.idef;
+
+    std::vector<int>& oldToNew = incremental->oldToNewHomeIndex;
+    oldToNew.resize(oldNumHomeAtoms);
+    dd.ga2la->findHome(incremental->homeAtomGlobalIndices, oldToNew);
+
+    const int numStayed = std::count_if(oldToNew.begin(), oldToNew.end(), [](int a) { return a >= 0; });
+    const int numChanged = (oldNumHomeAtoms - numStayed) + (numHomeAtoms - numStayed);
+    if (numChanged > c_maxChangedHomeAtomFractionForIncrementalUpdate * numHomeAtoms)
+    {
+        if (debug)
+        {
+            fprintf(debug, "%d home atoms changed, making the full local topology\n", numChanged);
+        }
+        return;
+    }
+
+    std::vector<char>& keep = incremental->keepOldHomeAtom;
+    keep.resize(oldNumHomeAtoms);
+    for (int a = 0; a < oldNumHomeAtoms; a++)
+    {
+        keep[a] = static_cast<char>(incremental->homeAtomIsSelfContained[a] && oldToNew[a] >= 0);
+    }
+
+    /* Interactions are linked to their first atom. We can only keep
+     * the interactions of an atom when all atoms of all its interactions
+     * are still home atoms.
+     */
+    for (int ftype = 0; ftype < F_NRE; ftype++)
+    {
+        if (idef.il[ftype].empty() || !canKeepInteractionType(rt, ftype))
+        {
+            continue;
+        }
+        const int                nral   = NRAL(ftype);
+        gmx::ArrayRef<const int> iatoms = idef.il[ftype].iatoms;
+        for (gmx::index i = 0; i < iatoms.ssize(); i += 1 + nral)
+        {
+            const int firstAtom = iatoms[i + 1];
+            if (firstAtom >= 0 && firstAtom < oldNumHomeAtoms && keep[firstAtom])
+            {
+                for (int k = 1; k <= nral; k++)
+                {
+                    const int a = iatoms[i + k];
+                    if (a < 0 || a >= oldNumHomeAtoms || oldToNew[a] < 0)
+                    {
+                        keep[firstAtom] = 0;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    for (int ftype = 0; ftype < F_NRE; ftype++)
+    {
+        if (idef.il[ftype].empty() || !canKeepInteractionType(rt, ftype))
+        {
+            continue;
+        }
+        const int                nral   = NRAL(ftype);
+        gmx::ArrayRef<const int> iatoms = idef.il[ftype].iatoms;
+        InteractionList&         kept   = incremental->keptInteractions[ftype];
+        for (gmx::index i = 0; i < iatoms.ssize(); i += 1 + nral)
+        {
+            const int firstAtom = iatoms[i + 1];
+            if (firstAtom >= 0 && firstAtom < oldNumHomeAtoms && keep[firstAtom])
+            {
+                t_iatom atoms[MAXATOMLIST];
+                for (int k = 0; k < nral; k++)
+                {
+                    atoms[k] = oldToNew[iatoms[i + 1 + k]];
+                }
+                kept.push_back(iatoms[i], nral, atoms);
+            }
+        }
+    }
+
+    for (int a = 0; a < oldNumHomeAtoms; a++)
+    {
+        if (keep[a])
+        {
+            incremental->homeAtomIsKept[oldToNew[a]] = 1;
+        }
+    }
+}
+
+/*! \brief Appends the kept interactions to \p idef and returns the number of bondeds for the check count */
+static int appendKeptHomeInteractions(const gmx_reverse_top_t&        rt,
+                                      const IncrementalLocalTopology& incremental,
+                                      InteractionDefinitions*         idef)
+{
+    int nbonded = 0;
+    for (int ftype = 0; ftype < F_NRE; ftype++)
+    {
+        const InteractionList& kept = incremental.keptInteractions[ftype];
+        if (kept.empty())
+        {
+            continue;
+        }
+        idef->il[ftype].append(kept);
+        if (rt.bBCheck || !(interaction_function[ftype].flags & IF_LIMZERO))
+        {
+            nbonded += kept.size() / (1 + NRAL(ftype));
+        }
+    }
+
+    return nbonded;
+}
+
 /*! \brief Generate and store all required local bonded interactions in \p idef and local exclusions in \p lexcls */
-static int make_local_bondeds_excls(gmx_domdec_t*           dd,
-                                    gmx_domdec_zones_t*     zones,
-                                    const gmx_mtop_t*       mtop,
-                                    const int*              cginfo,
-                                    gmx_bool                bRCheckMB,
-                                    ivec                    rcheck,
-                                    gmx_bool                bRCheck2B,
-                                    real                    rc,
-                                    t_pbc*                  pbc_null,
-                                    rvec*                   cg_cm,
-                                    InteractionDefinitions* idef,
-                                    ListOfLists<int>*       lexcls,
-                                    int*                    excl_count)
+static int make_local_bondeds_excls(gmx_domdec_t*             dd,
+                                    gmx_domdec_zones_t*       zones,
+                                    const gmx_mtop_t*         mtop,
+                                    const int*                cginfo,
+                                    gmx_bool                  bRCheckMB,
+                                    ivec                      rcheck,
+                                    gmx_bool                  bRCheck2B,
+                                    real                      rc,
+                                    t_pbc*                    pbc_null,
+                                    rvec*                     cg_cm,
+                                    InteractionDefinitions*   idef,
+                                    ListOfLists<int>*         lexcls,
+                                    int*                      excl_count,
+                                    IncrementalLocalTopology* incremental)
 {
     int                nzone_bondeds;
     int                cg0, cg1;
@@ -1424,6 +1652,15 @@ static int make_local_bondeds_excls(gmx_domdec_t*           dd,
 
     rc2 = rc * rc;
 
+    gmx::ArrayRef<const char> homeAtomIsKept;
+    gmx::ArrayRef<char>       homeAtomIsSelfContained;
+    if (incremental)
+    {
+        homeAtomIsKept = incremental->homeAtomIsKept;
+        incremental->homeAtomIsSelfContained.resize(zones->cg_range[1]);
+        homeAtomIsSelfContained = incremental->homeAtomIsSelfContained;
+    }
+
     /* Clear the counts */
     idef->clear();
     nbonded_local = 0;
@@ -1460,7 +1697,8 @@ static int make_local_bondeds_excls(gmx_domdec_t*           dd,
 
                 rt->th_work[thread].nbonded = make_bondeds_zone(
                         dd, zones, mtop->molblock, bRCheckMB, rcheck, bRCheck2B, rc2, pbc_null,
-                        cg_cm, idef->iparams.data(), idef_t, izone, gmx::Range<int>(cg0t, cg1t));
+                        cg_cm, idef->iparams.data(), idef_t, izone, gmx::Range<int>(cg0t, cg1t),
+                        homeAtomIsKept, homeAtomIsSelfContained);
 
                 if (izone < numIZonesForExclusions)
                 {
@@ -1590,9 +1828,44 @@ void dd_make_local_top(gmx_domdec_t*       dd,
         }
     }
 
+    /* Without distance checks, all interactions that only involve home atoms
+     * are assigned to this rank, so these can be kept when all their atoms
+     * are still home atoms. Intermolecular interactions are not linked to
+     * molecule types, so these we always look up.
+     */
+    gmx_reverse_top_t*        rt          = dd->reverse_top;
+    IncrementalLocalTopology* incremental = nullptr;
+    if (dd->comm->ddSettings.useIncrementalLocalTopology && !bRCheckMB && !bRCheck2B
+        && !rt->bIntermolecularInteractions)
+    {
+        incremental = &rt->incremental;
+        extractKeptHomeInteractions(*dd, *rt, *ltop, incremental);
+    }
+    else
+    {
+        rt->incremental.localTopology = nullptr;
+    }
+
     dd->nbonded_local = make_local_bondeds_excls(dd, zones, &mtop, fr->cginfo.data(), bRCheckMB,
                                                  rcheck, bRCheck2B, rc, pbc_null, cgcm_or_x,
-                                                 &ltop->idef, &ltop->excls, &nexcl);
+                                                 &ltop->idef, &ltop->excls, &nexcl, incremental);
+
+    if (incremental)
+    {
+        dd->nbonded_local += appendKeptHomeInteractions(*rt, *incremental, &ltop->idef);
+
+        const int numHomeAtoms = dd->comm->atomRanges.numHomeAtoms();
+        for (int a = 0; a < numHomeAtoms; a++)
+        {
+            if (incremental->homeAtomIsKept[a])
+            {
+                incremental->homeAtomIsSelfContained[a] = 1;
+            }
+        }
+        incremental->homeAtomGlobalIndices.assign(dd->globalAtomIndices.begin(),
+                                                  dd->globalAtomIndices.begin() + numHomeAtoms);
+        incremental->localTopology = ltop;
+    }
 
     /* The ilist is not sorted yet,
      * we can only do this when we have the charge arrays.
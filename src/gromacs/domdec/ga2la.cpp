@@ -45,6 +45,8 @@
 
 #include "ga2la.h"
 
+#include <algorithm>
+
 /*! \brief Returns whether to use a direct list only
  *
  * There are two methods implemented for finding the local atom number
@@ -80,3 +82,38 @@ gmx_ga2la_t::gmx_ga2la_t(int numAtomsTotal, int numAtomsLocal) :
         new (&(data_.hashed)) gmx::HashedMap<Entry>(numAtomsLocal);
     }
 }
+
+void gmx_ga2la_t::insertRange(gmx::ArrayRef<const int> globalAtomIndices,
+                              const int                localAtomStart,
+                              const int                cell,
+                              const int                numThreads)
+{
+    const int numAtoms = globalAtomIndices.ssize();
+
+    if (usingDirect_)
+    {
+        /* The global indices are unique, so the threads write to
+         * different entries and we can insert in parallel.
+         * Avoid the threading overhead for small ranges.
+         */
+        constexpr int c_minNumAtomsPerThread = 1024;
+        const int     numThreadsToUse =
+                std::max(1, std::min(numThreads, numAtoms / c_minNumAtomsPerThread));
+
+        Entry* direct = data_.direct.data();
+#pragma omp parallel for num_threads(numThreadsToUse) schedule(static)
+        for (int i = 0; i < numAtoms; i++)
+        {
+            GMX_ASSERT(direct[globalAtomIndices[i]].cell == -1,
+                       "The key to be inserted should not be present");
+            direct[globalAtomIndices[i]] = { localAtomStart + i, cell };
+        }
+    }
+    else
+    {
+        for (int i = 0; i < numAtoms; i++)
+        {
+            data_.hashed.insert(globalAtomIndices[i], { localAtomStart + i, cell });
+        }
+    }
+}
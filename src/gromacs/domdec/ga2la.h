@@ -52,6 +52,7 @@
 #include <vector>
 
 #include "gromacs/domdec/hashedmap.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/gmxassert.h"
 
 /*! \libinternal \brief Global to local atom mapping
@@ -97,6 +98,17 @@ public:
         }
     }
 
+    /*! \brief Inserts entries for consecutive local atoms, there should not already be entries for these atoms
+     *
+     * With the direct list, the entries are set using \p numThreads OpenMP threads.
+     *
+     * \param[in] globalAtomIndices  The global atom indices of the local atoms
+     * \param[in] localAtomStart     The local atom index of the first atom
+     * \param[in] cell               The cell value to set for all atoms
+     * \param[in] numThreads         The number of OpenMP threads to use
+     */
+    void insertRange(gmx::ArrayRef<const int> globalAtomIndices, int localAtomStart, int cell, int numThreads);
+
     //! Delete the entry for global atom a_gl
     void erase(int a_gl)
     {
@@ -130,6 +142,41 @@ public:
         return (e && e->cell == 0) ? &(e->la) : nullptr;
     }
 
+    /*! \brief Looks up the local indices of a list of atoms that are home atoms
+     *
+     * Sets the local atom index for each atom that is a home atom
+     * and -1 for atoms that are not home atoms. This is more efficient
+     * than calling findHome() for each atom, as the choice between
+     * the direct and the hashed list is made once for the whole list.
+     *
+     * \param[in]  globalAtomIndices  The global atom indices to look up
+     * \param[out] localAtomIndices   The local atom indices, should have the same size as \p globalAtomIndices
+     */
+    void findHome(gmx::ArrayRef<const int> globalAtomIndices, gmx::ArrayRef<int> localAtomIndices) const
+    {
+        GMX_ASSERT(globalAtomIndices.size() == localAtomIndices.size(),
+                   "The input and output lists should have the same size");
+
+        const int numAtoms = globalAtomIndices.ssize();
+        if (usingDirect_)
+        {
+            const Entry* direct = data_.direct.data();
+            for (int i = 0; i < numAtoms; i++)
+            {
+                const Entry& entry  = direct[globalAtomIndices[i]];
+                localAtomIndices[i] = (entry.cell == 0) ? entry.la : -1;
+            }
+        }
+        else
+        {
+            for (int i = 0; i < numAtoms; i++)
+            {
+                const Entry* entry  = data_.hashed.find(globalAtomIndices[i]);
+                localAtomIndices[i] = (entry && entry->cell == 0) ? entry->la : -1;
+            }
+        }
+    }
+
     /*! \brief Returns a reference to the entry for a_gl
      *
      * A non-release assert checks that a_gl is present.
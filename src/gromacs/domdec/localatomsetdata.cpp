@@ -73,18 +73,22 @@ void LocalAtomSetData::setLocalAndCollectiveIndices(const gmx_ga2la_t& ga2la)
      */
     int numAtomsGlobal = globalIndex_.size();
 
-    /* Clear vector without changing capacity,
-     * because we expect the size of the vectors to vary little. */
-    localIndex_.resize(0);
-    collectiveIndex_.resize(0);
+    /* Look up all atoms at once, atoms that are not home atoms get -1.
+     * Resizing does not change the capacity, because we expect the size
+     * of the vectors to vary little.
+     */
+    localIndex_.resize(numAtomsGlobal);
+    ga2la.findHome(globalIndex_, localIndex_);
 
+    int numAtomsLocal = 0;
+    collectiveIndex_.resize(0);
     for (int iCollective = 0; iCollective < numAtomsGlobal; iCollective++)
     {
-        if (const int* iLocal = ga2la.findHome(globalIndex_[iCollective]))
+        if (localIndex_[iCollective] >= 0)
         {
             /* Save the atoms index in the local atom numbers array */
             /* The atom with this index is a home atom. */
-            localIndex_.push_back(*iLocal);
+            localIndex_[numAtomsLocal++] = localIndex_[iCollective];
 
             /* Keep track of where this local atom belongs in the collective index array.
              * This is needed when reducing the local arrays to a collective/global array
@@ -92,6 +96,7 @@ void LocalAtomSetData::setLocalAndCollectiveIndices(const gmx_ga2la_t& ga2la)
             collectiveIndex_.push_back(iCollective);
         }
     }
+    localIndex_.resize(numAtomsLocal);
 }
 
 } // namespace internal
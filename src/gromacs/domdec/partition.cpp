@@ -95,6 +95,7 @@
 
 #include "box.h"
 #include "cellsizes.h"
+#include "directhalo.h"
 #include "distribute.h"
 #include "domdec_constraints.h"
 #include "domdec_internal.h"
@@ -489,9 +490,13 @@ static void make_dd_indices(gmx_domdec_t* dd, const int atomStart)
         gmx_incons("dd->ncg_zone is not up to date");
     }
 
-    /* Make the local to global and global to local atom index */
-    int a = atomStart;
-    globalAtomIndices.resize(a);
+    const int numThreads = gmx_omp_nthreads_get(emntDomdec);
+
+    /* Make the local to global and global to local atom index.
+     * As atom groups consist of single atoms, the global atom indices
+     * are the global atom group indices and we can insert whole ranges.
+     */
+    globalAtomIndices.resize(atomStart);
     for (int zone = 0; zone < numZones; zone++)
     {
         int cg0;
@@ -504,21 +509,14 @@ static void make_dd_indices(gmx_domdec_t* dd, const int atomStart)
             cg0 = zone2cg[zone];
         }
         int cg1    = zone2cg[zone + 1];
-        int cg1_p1 = cg0 + zone_ncg1[zone];
+        int cg1_p1 = std::min(cg0 + zone_ncg1[zone], cg1);
 
-        for (int cg = cg0; cg < cg1; cg++)
-        {
-            int zone1 = zone;
-            if (cg >= cg1_p1)
-            {
-                /* Signal that this cg is from more than one pulse away */
-                zone1 += numZones;
-            }
-            int cg_gl = globalAtomGroupIndices[cg];
-            globalAtomIndices.push_back(cg_gl);
-            ga2la.insert(cg_gl, { a, zone1 });
-            a++;
-        }
+        globalAtomIndices.insert(globalAtomIndices.end(), globalAtomGroupIndices.begin() + cg0,
+                                 globalAtomGroupIndices.begin() + cg1);
+        ga2la.insertRange(globalAtomGroupIndices.subArray(cg0, cg1_p1 - cg0), cg0, zone, numThreads);
+        /* Signal that these atoms are from more than one pulse away */
+        ga2la.insertRange(globalAtomGroupIndices.subArray(cg1_p1, cg1 - cg1_p1), cg1_p1,
+                          zone + numZones, numThreads);
     }
 }
 
@@ -1329,7 +1327,9 @@ static void merge_cg_buffers(int                            ncell,
                              gmx::ArrayRef<gmx::RVec>       x,
                              gmx::ArrayRef<const gmx::RVec> recv_vr,
                              gmx::ArrayRef<cginfo_mb_t>     cginfo_mb,
-                             gmx::ArrayRef<int>             cginfo)
+                             gmx::ArrayRef<int>             cginfo,
+                             gmx::ArrayRef<int>             origins,
+                             const int*                     recvOrigins)
 {
     gmx_domdec_ind_t *ind, *ind_p;
     int               p, cell, c, cg, cg0, cg1, cg_gl;
@@ -1352,6 +1352,10 @@ static void merge_cg_buffers(int                            ncell,
                 index_gl[cg + shift] = index_gl[cg];
                 x[cg + shift]        = x[cg];
                 cginfo[cg + shift]   = cginfo[cg];
+                if (!origins.empty())
+                {
+                    origins[cg + shift] = origins[cg];
+                }
             }
             /* Correct the already stored send indices for the shift */
             for (p = 1; p <= pulse; p++)
@@ -1385,6 +1389,10 @@ static void merge_cg_buffers(int                            ncell,
             /* Copy information */
             cg_gl       = index_gl[cg1];
             cginfo[cg1] = ddcginfo(cginfo_mb, cg_gl);
+            if (!origins.empty())
+            {
+                origins[cg1] = recvOrigins[cg0];
+            }
             cg0++;
             cg1++;
         }
@@ -1806,6 +1814,46 @@ static void clearCommSetupData(dd_comm_setup_work_t* work)
     work->nsend_zone = 0;
 }
 
+/*! \brief Communicates the global atom group indices together with the origins for the direct halo exchange
+ *
+ * The origins are interleaved with the global indices, so no extra
+ * messages are needed.
+ *
+ * \param[in,out] dd                 The domain decomposition struct
+ * \param[in]     dimIndex           The DD dimension index to communicate along
+ * \param[in]     ind                The indices to communicate for this pulse
+ * \param[in]     globalIndices      The global atom group indices to send
+ * \param[out]    globalIndicesRecv  The received global atom group indices
+ * \param[out]    originsRecv        The received atom origins
+ */
+static void sendrecvGlobalIndicesAndOrigins(gmx_domdec_t*            dd,
+                                            int                      dimIndex,
+                                            const gmx_domdec_ind_t&  ind,
+                                            gmx::ArrayRef<const int> globalIndices,
+                                            gmx::ArrayRef<int>       globalIndicesRecv,
+                                            gmx::ArrayRef<int>       originsRecv)
+{
+    DDDirectHaloSetup& directHalo = dd->comm->directHalo;
+    std::vector<int>&  buffer     = directHalo.originSetupBuffer;
+
+    const int numSend = ind.index.size();
+    const int numRecv = globalIndicesRecv.size();
+    buffer.resize(2 * (numSend + numRecv));
+    for (int i = 0; i < numSend; i++)
+    {
+        buffer[2 * i] = globalIndices[i];
+        buffer[2 * i + 1] =
+                ddDirectHaloOriginAfterPulse(directHalo.atomOrigins[ind.index[i]], dimIndex);
+    }
+    int* recvBuffer = buffer.data() + 2 * numSend;
+    ddSendrecv(dd, dimIndex, dddirBackward, buffer.data(), 2 * numSend, recvBuffer, 2 * numRecv);
+    for (int i = 0; i < numRecv; i++)
+    {
+        globalIndicesRecv[i] = recvBuffer[2 * i];
+        originsRecv[i]       = recvBuffer[2 * i + 1];
+    }
+}
+
 //! Prepare DD communication.
 static void setup_dd_communication(gmx_domdec_t* dd, matrix box, gmx_ddbox_t* ddbox, t_forcerec* fr, t_state* state)
 {
@@ -1897,6 +1945,14 @@ static void setup_dd_communication(gmx_domdec_t* dd, matrix box, gmx_ddbox_t* dd
     comm->zone_ncg1[0] = dd->ncg_home;
     pos_cg             = dd->ncg_home;
 
+    /* With the direct halo exchange, we track where the halo atoms come from */
+    const bool        setHaloAtomOrigins = comm->ddSettings.useDirectHaloExchange;
+    std::vector<int>& atomOrigins        = comm->directHalo.atomOrigins;
+    if (setHaloAtomOrigins)
+    {
+        atomOrigins.assign(dd->ncg_home, 0);
+    }
+
     nat_tot = comm->atomRanges.numHomeAtoms();
     nzone   = 1;
     for (dim_ind = 0; dim_ind < dd->ndim; dim_ind++)
@@ -2064,6 +2120,8 @@ static void setup_dd_communication(gmx_domdec_t* dd, matrix box, gmx_ddbox_t* dd
             /* These buffer are actually only needed with in-place */
             DDBufferAccess<int>       globalAtomGroupBuffer(comm->intBuffer, receiveBufferSize);
             DDBufferAccess<gmx::RVec> rvecBuffer(comm->rvecBuffer, receiveBufferSize);
+            std::vector<int>&         originBuffer = comm->directHalo.originMergeBuffer;
+            originBuffer.resize(setHaloAtomOrigins ? receiveBufferSize : 0);
 
             dd_comm_setup_work_t& work = comm->dth[0];
 
@@ -2081,7 +2139,26 @@ static void setup_dd_communication(gmx_domdec_t* dd, matrix box, gmx_ddbox_t* dd
             {
                 integerBufferRef = globalAtomGroupBuffer.buffer;
             }
-            ddSendrecv<int>(dd, dim_ind, dddirBackward, work.atomGroupBuffer, integerBufferRef);
+            if (setHaloAtomOrigins)
+            {
+                atomOrigins.resize(numAtomGroupsNew);
+                gmx::ArrayRef<int> originBufferRef;
+                if (cd->receiveInPlace)
+                {
+                    originBufferRef = gmx::arrayRefFromArray(atomOrigins.data() + pos_cg,
+                                                             ind->nrecv[nzone]);
+                }
+                else
+                {
+                    originBufferRef = originBuffer;
+                }
+                sendrecvGlobalIndicesAndOrigins(dd, dim_ind, *ind, work.atomGroupBuffer,
+                                                integerBufferRef, originBufferRef);
+            }
+            else
+            {
+                ddSendrecv<int>(dd, dim_ind, dddirBackward, work.atomGroupBuffer, integerBufferRef);
+            }
 
             /* Make space for cg_cm */
             dd_resize_atominfo_and_state(fr, state, pos_cg + ind->nrecv[nzone]);
@@ -2123,7 +2200,8 @@ static void setup_dd_communication(gmx_domdec_t* dd, matrix box, gmx_ddbox_t* dd
                 /* This part of the code is never executed with bBondComm. */
                 merge_cg_buffers(nzone, cd, p, zone_cg_range, dd->globalAtomGroupIndices,
                                  integerBufferRef.data(), state->x, rvecBufferRef, fr->cginfo_mb,
-                                 fr->cginfo);
+                                 fr->cginfo, setHaloAtomOrigins ? atomOrigins : gmx::ArrayRef<int>(),
+                                 originBuffer.data());
                 pos_cg += ind->nrecv[nzone];
             }
             nat_tot += ind->nrecv[nzone + 1];
@@ -3046,6 +3124,12 @@ void dd_partition_system(FILE*                     fplog,
     /* Setup up the communication and communicate the coordinates */
     setup_dd_communication(dd, state_local->box, &ddbox, fr, state_local);
 
+    if (comm->ddSettings.useDirectHaloExchange)
+    {
+        /* Derive the single-round halo communication from the pulse setup */
+        setupDirectHaloExchange(dd);
+    }
+
     /* Set the indices for the halo atoms */
     make_dd_indices(dd, dd->ncg_home);
 
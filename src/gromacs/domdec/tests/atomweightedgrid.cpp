@@ -0,0 +1,206 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the atom-weighted static DD cell sizes.
+ *
+ * \ingroup module_domdec
+ */
+#include "gmxpre.h"
+
+#include <numeric>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/domdec/domdec_internal.h"
+#include "gromacs/domdec/domdec_setup.h"
+#include "gromacs/domdec/domdec_struct.h"
+#include "gromacs/math/vectypes.h"
+
+#include "testutils/testasserts.h"
+
+namespace
+{
+
+//! Box length along each dimension
+constexpr real c_boxLength = 10;
+//! Number of cells along the decomposed dimension
+constexpr int c_numCells = 4;
+
+//! Returns a rectangular DD box of size c_boxLength with PBC in all dimensions
+gmx_ddbox_t rectangularDDBox()
+{
+    gmx_ddbox_t ddbox;
+    ddbox.npbcdim     = DIM;
+    ddbox.nboundeddim = DIM;
+    ddbox.box_size    = { c_boxLength, c_boxLength, c_boxLength };
+    ddbox.skew_fac    = { 1, 1, 1 };
+    return ddbox;
+}
+
+//! Returns system info with cut-off \p cutoff
+DDSystemInfo systemInfoWithCutoff(real cutoff)
+{
+    DDSystemInfo systemInfo;
+    systemInfo.cutoff = cutoff;
+    return systemInfo;
+}
+
+/*! \brief Returns a slab of atoms between z=4 and z=6, evenly spaced along z
+ *
+ * Along x the atoms are uniformly spread over the whole box.
+ */
+std::vector<gmx::RVec> slabCoordinates()
+{
+    const int              numAtoms = 400;
+    std::vector<gmx::RVec> x;
+    for (int i = 0; i < numAtoms; i++)
+    {
+        const real s = (i + 0.5_real) / numAtoms;
+        x.emplace_back(c_boxLength * s, 5, 4 + 2 * s);
+    }
+    return x;
+}
+
+//! Returns the number of atoms in each cell along \p dim given the relative sizes \p fractions
+std::vector<int> atomCountsPerCell(int                           dim,
+                                   const std::vector<real>&      fractions,
+                                   const std::vector<gmx::RVec>& x)
+{
+    std::vector<int> counts(fractions.size(), 0);
+    for (const gmx::RVec& xAtom : x)
+    {
+        const real f     = xAtom[dim] / c_boxLength;
+        real       upper = 0;
+        for (std::size_t cell = 0; cell < fractions.size(); cell++)
+        {
+            upper += fractions[cell];
+            if (f < upper || cell + 1 == fractions.size())
+            {
+                counts[cell]++;
+                break;
+            }
+        }
+    }
+    return counts;
+}
+
+TEST(AtomWeightedCellFractionsTest, SlabGetsEqualAtomCountsPerCell)
+{
+    const std::vector<gmx::RVec> x = slabCoordinates();
+
+    const std::vector<real> fractions = atomWeightedCellFractions(
+            ZZ, c_numCells, systemInfoWithCutoff(0.2), rectangularDDBox(), x);
+
+    ASSERT_EQ(c_numCells, fractions.size());
+    const auto tolerance = gmx::test::absoluteTolerance(1e-4);
+    EXPECT_REAL_EQ_TOL(1, std::accumulate(fractions.begin(), fractions.end(), 0.0_real), tolerance);
+    /* The two inner cells span the slab, the outer cells include the vacuum */
+    EXPECT_REAL_EQ_TOL(0.45, fractions[0], gmx::test::absoluteTolerance(1e-3));
+    EXPECT_REAL_EQ_TOL(0.05, fractions[1], tolerance);
+    EXPECT_REAL_EQ_TOL(0.05, fractions[2], tolerance);
+    EXPECT_REAL_EQ_TOL(0.45, fractions[3], gmx::test::absoluteTolerance(1e-3));
+    for (const int count : atomCountsPerCell(ZZ, fractions, x))
+    {
+        EXPECT_EQ(x.size() / c_numCells, count);
+    }
+}
+
+TEST(AtomWeightedCellFractionsTest, UniformDimensionGetsUniformCells)
+{
+    const std::vector<gmx::RVec> x = slabCoordinates();
+
+    const std::vector<real> fractions = atomWeightedCellFractions(
+            XX, c_numCells, systemInfoWithCutoff(0.2), rectangularDDBox(), x);
+
+    ASSERT_EQ(c_numCells, fractions.size());
+    for (const real fraction : fractions)
+    {
+        /* The quantiles are off by up to half the atom spacing */
+        EXPECT_REAL_EQ_TOL(1.0_real / c_numCells, fraction, gmx::test::absoluteTolerance(2e-3));
+    }
+}
+
+TEST(AtomWeightedCellFractionsTest, SlabCellsAreBlendedToObeyMinimumSize)
+{
+    const std::vector<gmx::RVec> x = slabCoordinates();
+    const gmx_ddbox_t            ddbox = rectangularDDBox();
+
+    const std::vector<real> unblended =
+            atomWeightedCellFractions(ZZ, c_numCells, systemInfoWithCutoff(0.2), ddbox, x);
+    /* With a cut-off of 1 the inner cells need at least 0.1 of the box,
+     * which is first reached at a uniform weight of 3/8 */
+    const std::vector<real> fractions =
+            atomWeightedCellFractions(ZZ, c_numCells, systemInfoWithCutoff(1.0), ddbox, x);
+
+    ASSERT_EQ(c_numCells, unblended.size());
+    ASSERT_EQ(c_numCells, fractions.size());
+    const real uniformWeight = 3.0_real / 8;
+    const auto tolerance     = gmx::test::absoluteTolerance(1e-5);
+    for (int i = 0; i < c_numCells; i++)
+    {
+        EXPECT_REAL_EQ_TOL((1 - uniformWeight) * unblended[i] + uniformWeight / c_numCells,
+                           fractions[i], tolerance);
+        EXPECT_GE(fractions[i] * c_boxLength, 1.0_real);
+    }
+    EXPECT_REAL_EQ_TOL(0.125, fractions[1], tolerance);
+    EXPECT_REAL_EQ_TOL(0.125, fractions[2], tolerance);
+}
+
+TEST(AtomWeightedCellFractionsTest, ReturnsUniformWhenCellsCannotObeyMinimumSize)
+{
+    const std::vector<gmx::RVec> x = slabCoordinates();
+
+    /* Four cells of at least 2.6 do not fit in the box */
+    const std::vector<real> fractions = atomWeightedCellFractions(
+            ZZ, c_numCells, systemInfoWithCutoff(2.6), rectangularDDBox(), x);
+
+    EXPECT_TRUE(fractions.empty());
+}
+
+TEST(AtomWeightedCellFractionsTest, ReturnsUniformAlongTriclinicDimension)
+{
+    const std::vector<gmx::RVec> x     = slabCoordinates();
+    gmx_ddbox_t                  ddbox = rectangularDDBox();
+    ddbox.tric_dir[ZZ]                 = 1;
+
+    const std::vector<real> fractions =
+            atomWeightedCellFractions(ZZ, c_numCells, systemInfoWithCutoff(0.2), ddbox, x);
+
+    EXPECT_TRUE(fractions.empty());
+}
+
+} // namespace
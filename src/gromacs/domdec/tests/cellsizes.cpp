@@ -0,0 +1,156 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the prediction of load balanced cell sizes.
+ *
+ * \ingroup module_domdec
+ */
+#include "gmxpre.h"
+
+#include "gromacs/domdec/cellsizes.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/utility/arrayref.h"
+
+#include "testutils/testasserts.h"
+
+namespace
+{
+
+//! Returns the cell sizes for the boundaries \p cellFrac
+std::vector<real> cellSizesFromBoundaries(gmx::ArrayRef<const real> cellFrac)
+{
+    std::vector<real> cellSize;
+    for (gmx::index i = 0; i + 1 < cellFrac.ssize(); i++)
+    {
+        cellSize.push_back(cellFrac[i + 1] - cellFrac[i]);
+    }
+    return cellSize;
+}
+
+TEST(CellSizesTest, BalancedLoadKeepsCellSizes)
+{
+    const std::vector<real> cellFrac = { 0, 0.2, 0.5, 0.7, 1 };
+    const std::vector<real> cellLoad = { 3, 3, 3, 3 };
+    std::vector<real>       cellSize(cellLoad.size());
+
+    predictBalancedCellSizes(cellFrac, cellLoad, 1, 1, cellSize);
+
+    const std::vector<real> expected = cellSizesFromBoundaries(cellFrac);
+    const auto              tolerance = gmx::test::absoluteTolerance(1e-6);
+    for (std::size_t i = 0; i < cellSize.size(); i++)
+    {
+        EXPECT_REAL_EQ_TOL(expected[i], cellSize[i], tolerance);
+    }
+}
+
+TEST(CellSizesTest, PredictsBalancedBoundaries)
+{
+    const std::vector<real> cellFrac = { 0, 0.25, 0.5, 0.75, 1 };
+    const std::vector<real> cellLoad = { 2, 1, 1, 2 };
+    std::vector<real>       cellSize(cellLoad.size());
+
+    predictBalancedCellSizes(cellFrac, cellLoad, 1, 1, cellSize);
+
+    // Each cell should get a load of 1.5 with a uniform load within the current cells
+    const std::vector<real> expected  = { 0.1875, 0.3125, 0.3125, 0.1875 };
+    const auto              tolerance = gmx::test::absoluteTolerance(1e-6);
+    for (std::size_t i = 0; i < cellSize.size(); i++)
+    {
+        EXPECT_REAL_EQ_TOL(expected[i], cellSize[i], tolerance);
+    }
+}
+
+TEST(CellSizesTest, DampsAndLimitsBoundaryShifts)
+{
+    const std::vector<real> cellFrac = { 0, 0.25, 0.5, 0.75, 1 };
+    const std::vector<real> cellLoad = { 2, 1, 1, 2 };
+    std::vector<real>       cellSize(cellLoad.size());
+
+    // Half of the predicted shift of 0.0625
+    predictBalancedCellSizes(cellFrac, cellLoad, 0.5, 1, cellSize);
+    EXPECT_REAL_EQ_TOL(0.21875, cellSize[0], gmx::test::absoluteTolerance(1e-6));
+
+    // Shifts limited to half of 10% of the cell size
+    predictBalancedCellSizes(cellFrac, cellLoad, 1, 0.1, cellSize);
+    EXPECT_REAL_EQ_TOL(0.2375, cellSize[0], gmx::test::absoluteTolerance(1e-6));
+}
+
+TEST(CellSizesTest, ConvergesForInhomogeneousLoad)
+{
+    /* The load density is 10 in a slab in the middle and 1 elsewhere,
+     * similar to a membrane in water.
+     */
+    const real slabStart = 0.4;
+    const real slabEnd   = 0.5;
+    auto       cumulativeLoad = [slabStart, slabEnd](real x) {
+        return x + 9 * std::max(real(0), std::min(x, slabEnd) - slabStart);
+    };
+
+    const int         numCells = 6;
+    std::vector<real> cellFrac(numCells + 1);
+    for (int i = 0; i <= numCells; i++)
+    {
+        cellFrac[i] = i / real(numCells);
+    }
+    std::vector<real> cellLoad(numCells);
+    std::vector<real> cellSize(numCells);
+    for (int iteration = 0; iteration < 40; iteration++)
+    {
+        for (int i = 0; i < numCells; i++)
+        {
+            cellLoad[i] = cumulativeLoad(cellFrac[i + 1]) - cumulativeLoad(cellFrac[i]);
+        }
+        predictBalancedCellSizes(cellFrac, cellLoad, 0.5, 1, cellSize);
+        for (int i = 0; i < numCells; i++)
+        {
+            cellFrac[i + 1] = cellFrac[i] + cellSize[i];
+        }
+    }
+
+    const real averageLoad = cumulativeLoad(1) / numCells;
+    for (int i = 0; i < numCells; i++)
+    {
+        EXPECT_REAL_EQ_TOL(averageLoad, cumulativeLoad(cellFrac[i + 1]) - cumulativeLoad(cellFrac[i]),
+                           gmx::test::relativeToleranceAsFloatingPoint(averageLoad, 1e-3));
+    }
+}
+
+} // namespace
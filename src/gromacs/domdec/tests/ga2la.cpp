@@ -0,0 +1,113 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the global to local atom lookup.
+ *
+ * \ingroup module_domdec
+ */
+#include "gmxpre.h"
+
+#include "gromacs/domdec/ga2la.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "testutils/testasserts.h"
+
+namespace
+{
+
+/*! \brief Fills \p ga2la with home atoms and atoms in zone 1 using range insertion
+ *
+ * Global atom i * 3 is local atom i, the first \p numHomeAtoms are home atoms.
+ */
+void fillRanges(gmx_ga2la_t* ga2la, int numHomeAtoms, int numAtoms)
+{
+    std::vector<int> globalAtomIndices;
+    for (int i = 0; i < numAtoms; i++)
+    {
+        globalAtomIndices.push_back(i * 3);
+    }
+    gmx::ArrayRef<const int> indices = globalAtomIndices;
+    ga2la->insertRange(indices.subArray(0, numHomeAtoms), 0, 0, 2);
+    ga2la->insertRange(indices.subArray(numHomeAtoms, numAtoms - numHomeAtoms), numHomeAtoms, 1, 2);
+}
+
+/*! \brief Checks range insertion and batched home atom lookup
+ *
+ * \param[in] numAtomsTotal  The total number of atoms, determines whether the direct or hashed list is used
+ */
+void checkInsertRangeAndFindHome(int numAtomsTotal)
+{
+    const int   numHomeAtoms = 2000;
+    const int   numAtoms     = 3000;
+    gmx_ga2la_t ga2la(numAtomsTotal, numAtoms);
+    fillRanges(&ga2la, numHomeAtoms, numAtoms);
+
+    for (int i = 0; i < numAtoms; i++)
+    {
+        const gmx_ga2la_t::Entry* entry = ga2la.find(i * 3);
+        ASSERT_NE(entry, nullptr);
+        EXPECT_EQ(entry->la, i);
+        EXPECT_EQ(entry->cell, i < numHomeAtoms ? 0 : 1);
+        EXPECT_EQ(ga2la.find(i * 3 + 1), nullptr);
+    }
+
+    // Look up home atoms, atoms in zone 1 and atoms that are not present
+    const std::vector<int> globalAtomIndices = { 3, 0, 3 * (numAtoms - 1), 7, 3 * (numHomeAtoms - 1) };
+    std::vector<int>       localAtomIndices(globalAtomIndices.size());
+    ga2la.findHome(globalAtomIndices, localAtomIndices);
+    const std::vector<int> expected = { 1, 0, -1, -1, numHomeAtoms - 1 };
+    EXPECT_EQ(localAtomIndices, expected);
+    for (size_t i = 0; i < globalAtomIndices.size(); i++)
+    {
+        const int* homeIndex = ga2la.findHome(globalAtomIndices[i]);
+        EXPECT_EQ(homeIndex ? *homeIndex : -1, expected[i]);
+    }
+}
+
+TEST(GlobalToLocalAtoms, InsertsRangesAndFindsHomeWithDirectList)
+{
+    checkInsertRangeAndFindHome(9000);
+}
+
+TEST(GlobalToLocalAtoms, InsertsRangesAndFindsHomeWithHashedList)
+{
+    checkInsertRangeAndFindHome(100000);
+}
+
+} // namespace
@@ -40,7 +40,8 @@
  *  pulse configirations. Each pulse involves a few non-contiguous
  *  indices. The sending rank, atom number and spatial 3D index are
  *  encoded in the x values, to allow correctness checking following
- *  the halo exchange.
+ *  the halo exchange. The CPU codepath is also tested with the
+ *  single-round direct halo communication.
  *
  * \todo Add 3D case
  *
@@ -53,11 +54,15 @@
 #include "config.h"
 
 #include <array>
+#include <memory>
+#include <numeric>
 
 #include <gtest/gtest.h>
 
 #include "gromacs/domdec/atomdistribution.h"
+#include "gromacs/domdec/directhalo.h"
 #include "gromacs/domdec/domdec_internal.h"
+#include "gromacs/domdec/ga2la.h"
 #include "gromacs/domdec/gpuhaloexchange.h"
 #if GMX_GPU_CUDA
 #    include "gromacs/gpu_utils/device_stream.h"
@@ -65,7 +70,11 @@
 #    include "gromacs/gpu_utils/gpueventsynchronizer.cuh"
 #endif
 #include "gromacs/gpu_utils/hostallocator.h"
+#include "gromacs/math/paddedvector.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/mdtypes/forceoutput.h"
 #include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/pbcutil/ishift.h"
 
 #include "testutils/mpitest.h"
 #include "testutils/test_hardware_environment.h"
@@ -697,6 +706,384 @@ TEST(HaloExchangeTest, Coordinates2dHaloWith2PulsesInDim1)
 #endif
 }
 
+/*! \brief Domain decomposition setup for testing the direct halo exchange on 4 ranks
+ *
+ * The DD grid is set up with the rank ordering of the default non-Cartesian
+ * rank setup. All ranks use the same pulse index lists, so the global atom
+ * indices and the origins of all halo atoms can be derived locally, which
+ * is done here in the same way as with the pulse communication setup.
+ */
+class DirectHaloTestSetup
+{
+public:
+    /*! \brief Constructor
+     *
+     * \param [in] numCells      The number of DD cells along x, y and z, the product should be 4
+     * \param [in] pulseIndices  For each DD dimension index and pulse, the local atom indices to send
+     * \param [in] numHomeAtoms  Number of home atoms
+     */
+    DirectHaloTestSetup(const IVec&                                     numCells,
+                        const std::vector<std::vector<std::vector<int>>>& pulseIndices,
+                        const int                                         numHomeAtoms) :
+        dd_(ir_),
+        numHomeAtoms_(numHomeAtoms)
+    {
+        dd_.mpi_comm_all = MPI_COMM_WORLD;
+        MPI_Comm_rank(MPI_COMM_WORLD, &dd_.rank);
+        dd_.comm                      = &comm_;
+        dd_.unitCellInfo.haveScrewPBC = false;
+
+        dd_.ndim = 0;
+        for (int dim = 0; dim < DIM; dim++)
+        {
+            dd_.numCells[dim] = numCells[dim];
+            if (numCells[dim] > 1)
+            {
+                dd_.dim[dd_.ndim++] = dim;
+            }
+        }
+        GMX_RELEASE_ASSERT(numCells[XX] * numCells[YY] * numCells[ZZ] == 4,
+                           "The test should run with 4 DD cells");
+        GMX_RELEASE_ASSERT(dd_.ndim == gmx::ssize(pulseIndices),
+                           "We need pulses for each DD dimension");
+
+        dd_.ci[XX] = dd_.rank / (numCells[YY] * numCells[ZZ]);
+        dd_.ci[YY] = (dd_.rank / numCells[ZZ]) % numCells[YY];
+        dd_.ci[ZZ] = dd_.rank % numCells[ZZ];
+
+        for (int d = 0; d < dd_.ndim; d++)
+        {
+            const int dim = dd_.dim[d];
+            ivec      cell;
+            copy_ivec(dd_.ci, cell);
+            cell[dim]         = (dd_.ci[dim] + 1) % numCells[dim];
+            dd_.neighbor[d][0] = ddcoord2ddnodeid(&dd_, cell);
+            cell[dim]         = (dd_.ci[dim] - 1 + numCells[dim]) % numCells[dim];
+            dd_.neighbor[d][1] = ddcoord2ddnodeid(&dd_, cell);
+        }
+
+        // Set up the pulses and propagate the origins and home indices of the atoms
+        std::vector<int>& origins = comm_.directHalo.atomOrigins;
+        origins.assign(numHomeAtoms, 0);
+        std::vector<int> homeIndices(numHomeAtoms);
+        std::iota(homeIndices.begin(), homeIndices.end(), 0);
+        int nzone = 1;
+        for (int d = 0; d < dd_.ndim; d++)
+        {
+            comm_.cd[d].receiveInPlace = true;
+            comm_.cd[d].ind.clear();
+            for (const std::vector<int>& index : pulseIndices[d])
+            {
+                gmx_domdec_ind_t ind;
+                ind.index            = index;
+                ind.nsend[nzone + 1] = index.size();
+                ind.nrecv[nzone + 1] = index.size();
+                comm_.cd[d].ind.push_back(ind);
+
+                for (int i : index)
+                {
+                    origins.push_back(ddDirectHaloOriginAfterPulse(origins[i], d));
+                    homeIndices.push_back(homeIndices[i]);
+                }
+            }
+            nzone += nzone;
+        }
+        comm_.zones.n = nzone;
+
+        const int numAtomsTotal = gmx::ssize(origins);
+        comm_.atomRanges.setEnd(DDAtomRanges::Type::Home, numHomeAtoms);
+        comm_.atomRanges.setEnd(DDAtomRanges::Type::Zones, numAtomsTotal);
+
+        // The global atom index follows from the home rank and home index
+        for (int i = 0; i < numAtomsTotal; i++)
+        {
+            ivec cell;
+            copy_ivec(dd_.ci, cell);
+            for (int d = 0; d < dd_.ndim; d++)
+            {
+                const int dim = dd_.dim[d];
+                cell[dim] = (dd_.ci[dim] + ddDirectHaloOriginOffset(origins[i], d)) % numCells[dim];
+            }
+            dd_.globalAtomGroupIndices.push_back(ddcoord2ddnodeid(&dd_, cell) * numHomeAtoms
+                                                 + homeIndices[i]);
+        }
+
+        ga2la_ = std::make_unique<gmx_ga2la_t>(4 * numHomeAtoms, numAtomsTotal);
+        for (int i = 0; i < numHomeAtoms; i++)
+        {
+            ga2la_->insert(dd_.globalAtomGroupIndices[i], { i, 0 });
+        }
+        dd_.ga2la = ga2la_.get();
+    }
+
+    //! Returns the domain decomposition object
+    gmx_domdec_t* dd() { return &dd_; }
+
+    //! Returns the number of home atoms
+    int numHomeAtoms() const { return numHomeAtoms_; }
+
+    //! Returns the number of home plus halo atoms
+    int numAtomsTotal() const { return comm_.atomRanges.end(DDAtomRanges::Type::Zones); }
+
+private:
+    //! Input record, needed for constructing the DD object
+    t_inputrec ir_;
+    //! DD communication data
+    gmx_domdec_comm_t comm_;
+    //! Domain decomposition object
+    gmx_domdec_t dd_;
+    //! Global to local atom lookup
+    std::unique_ptr<gmx_ga2la_t> ga2la_;
+    //! Number of home atoms
+    int numHomeAtoms_;
+};
+
+//! Returns a triclinic box with exactly representable elements
+void setTestBox(matrix box)
+{
+    clear_mat(box);
+    box[XX][XX] = 8;
+    box[YY][XX] = 1;
+    box[YY][YY] = 6;
+    box[ZZ][XX] = 2;
+    box[ZZ][YY] = 1.5;
+    box[ZZ][ZZ] = 5;
+}
+
+/*! \brief Checks that the direct coordinate halo exchange gives the same result as the pulses
+ *
+ * All coordinates and shifts are exactly representable, so we can check for equality.
+ *
+ * \param [in] setup            The DD test setup
+ * \param [in] useStartFinish   Whether to use the split start and finish calls
+ */
+void checkDirectCoordinateHaloExchange(DirectHaloTestSetup* setup, const bool useStartFinish)
+{
+    gmx_domdec_t* dd = setup->dd();
+    matrix        box;
+    setTestBox(box);
+
+    std::array<std::vector<RVec>, 2> x;
+    for (auto& xi : x)
+    {
+        xi.resize(setup->numAtomsTotal());
+        initHaloData(xi.data(), setup->numHomeAtoms(), setup->numAtomsTotal());
+    }
+
+    dd->comm->ddSettings.useDirectHaloExchange = false;
+    dd_move_x(dd, box, x[0], nullptr);
+
+    dd->comm->ddSettings.useDirectHaloExchange = true;
+    setupDirectHaloExchange(dd);
+    if (useStartFinish)
+    {
+        ASSERT_TRUE(dd_haloExchangeCanOverlapCompute(*dd));
+        dd_move_x_start(dd, box, x[1], nullptr);
+        dd_move_x_finish(dd, x[1], nullptr);
+    }
+    else
+    {
+        dd_move_x(dd, box, x[1], nullptr);
+    }
+    dd->comm->ddSettings.useDirectHaloExchange = false;
+
+    for (int i = 0; i < setup->numAtomsTotal(); i++)
+    {
+        for (int j = 0; j < DIM; j++)
+        {
+            EXPECT_EQ(x[0][i][j], x[1][i][j]) << "for atom " << i << " on rank " << dd->rank;
+        }
+    }
+}
+
+/*! \brief Checks that the direct force halo exchange gives the same result as the pulses
+ *
+ * The shift forces are accumulated on different ranks with the two
+ * communication setups, so we compare the shift forces summed over ranks.
+ * All forces are integer valued, so we can check for equality.
+ *
+ * \param [in] setup            The DD test setup
+ * \param [in] useStartFinish   Whether to use the split start and finish calls
+ */
+void checkDirectForceHaloExchange(DirectHaloTestSetup* setup, const bool useStartFinish)
+{
+    gmx_domdec_t* dd = setup->dd();
+
+    std::array<PaddedVector<RVec>, 2> forces;
+    std::array<std::vector<RVec>, 2>  shiftForces;
+    for (int k = 0; k < 2; k++)
+    {
+        forces[k].resizeWithPadding(setup->numAtomsTotal());
+        initHaloData(forces[k].data(), setup->numAtomsTotal(), setup->numAtomsTotal());
+        shiftForces[k].assign(SHIFTS, { 0, 0, 0 });
+    }
+
+    dd->comm->ddSettings.useDirectHaloExchange = false;
+    ForceWithShiftForces pulseForces(forces[0].arrayRefWithPadding(), true, shiftForces[0]);
+    dd_move_f(dd, &pulseForces, nullptr);
+
+    dd->comm->ddSettings.useDirectHaloExchange = true;
+    setupDirectHaloExchange(dd);
+    ForceWithShiftForces directForces(forces[1].arrayRefWithPadding(), true, shiftForces[1]);
+    if (useStartFinish)
+    {
+        dd_move_f_start(dd, &directForces, nullptr);
+        dd_move_f_finish(dd, &directForces, nullptr);
+    }
+    else
+    {
+        dd_move_f(dd, &directForces, nullptr);
+    }
+    dd->comm->ddSettings.useDirectHaloExchange = false;
+
+    for (int i = 0; i < setup->numHomeAtoms(); i++)
+    {
+        for (int j = 0; j < DIM; j++)
+        {
+            EXPECT_EQ(forces[0][i][j], forces[1][i][j]) << "for atom " << i << " on rank " << dd->rank;
+        }
+    }
+
+    for (auto& fshift : shiftForces)
+    {
+        MPI_Allreduce(MPI_IN_PLACE, fshift.data(), SHIFTS * DIM, GMX_MPI_REAL, MPI_SUM, MPI_COMM_WORLD);
+    }
+    for (int s = 0; s < SHIFTS; s++)
+    {
+        for (int j = 0; j < DIM; j++)
+        {
+            EXPECT_EQ(shiftForces[0][s][j], shiftForces[1][s][j]) << "for shift index " << s;
+        }
+    }
+}
+
+//! Returns a DD setup with 4 cells along x and 2 pulses with non-contiguous indices
+std::unique_ptr<DirectHaloTestSetup> direct1dHaloWith2Pulses()
+{
+    // The second pulse forwards atoms received with the first pulse, in reverse order
+    return std::make_unique<DirectHaloTestSetup>(
+            IVec(4, 1, 1), std::vector<std::vector<std::vector<int>>>{ { { 1, 3, 6 }, { 11, 10 } } }, 10);
+}
+
+/*! \brief Returns a DD setup with 2x2 cells and 1 pulse in each dimension
+ *
+ * The pulse along y forwards home atoms and atoms received along x
+ * interleaved, so the atoms from the diagonal neighbor are not contiguous.
+ */
+std::unique_ptr<DirectHaloTestSetup> direct2dHaloWith1PulseInEachDim()
+{
+    return std::make_unique<DirectHaloTestSetup>(
+            IVec(2, 2, 1),
+            std::vector<std::vector<std::vector<int>>>{ { { 1, 3, 6 } }, { { 2, 11, 5, 10 } } }, 10);
+}
+
+TEST(HaloExchangeTest, Coordinates1dHaloWith2PulsesDirect)
+{
+    GMX_MPI_TEST(4);
+
+    checkDirectCoordinateHaloExchange(direct1dHaloWith2Pulses().get(), false);
+}
+
+TEST(HaloExchangeTest, Coordinates2dHaloWith1PulseInEachDimDirect)
+{
+    GMX_MPI_TEST(4);
+
+    checkDirectCoordinateHaloExchange(direct2dHaloWith1PulseInEachDim().get(), false);
+}
+
+TEST(HaloExchangeTest, Coordinates2dHaloWith1PulseInEachDimDirectOverlapped)
+{
+    GMX_MPI_TEST(4);
+
+    checkDirectCoordinateHaloExchange(direct2dHaloWith1PulseInEachDim().get(), true);
+}
+
+TEST(HaloExchangeTest, Forces1dHaloWith2PulsesDirect)
+{
+    GMX_MPI_TEST(4);
+
+    checkDirectForceHaloExchange(direct1dHaloWith2Pulses().get(), false);
+}
+
+TEST(HaloExchangeTest, Forces2dHaloWith1PulseInEachDimDirect)
+{
+    GMX_MPI_TEST(4);
+
+    checkDirectForceHaloExchange(direct2dHaloWith1PulseInEachDim().get(), false);
+}
+
+TEST(HaloExchangeTest, Forces2dHaloWith1PulseInEachDimDirectOverlapped)
+{
+    GMX_MPI_TEST(4);
+
+    checkDirectForceHaloExchange(direct2dHaloWith1PulseInEachDim().get(), true);
+}
+
+TEST(HaloExchangeTest, CoordinatesAndForces2dHaloDirectWithMultipleBuffers)
+{
+    GMX_MPI_TEST(4);
+
+    std::unique_ptr<DirectHaloTestSetup> setup         = direct2dHaloWith1PulseInEachDim();
+    gmx_domdec_t*                        dd            = setup->dd();
+    const int                            numHomeAtoms  = setup->numHomeAtoms();
+    const int                            numAtomsTotal = setup->numAtomsTotal();
+    matrix                               box;
+    setTestBox(box);
+
+    // Compute the reference results with the pulses
+    std::vector<RVec> xReference(numAtomsTotal);
+    initHaloData(xReference.data(), numHomeAtoms, numAtomsTotal);
+    dd_move_x(dd, box, xReference, nullptr);
+
+    PaddedVector<RVec> fReference;
+    fReference.resizeWithPadding(numAtomsTotal);
+    initHaloData(fReference.data(), numAtomsTotal, numAtomsTotal);
+    ForceWithShiftForces referenceForces(fReference.arrayRefWithPadding(), false, {});
+    dd_move_f(dd, &referenceForces, nullptr);
+
+    dd->comm->ddSettings.useDirectHaloExchange = true;
+    setupDirectHaloExchange(dd);
+
+    /* With an MPI library, persistent requests are set up for each
+     * buffer that is communicated, so we alternate between buffers
+     * and use the same buffer multiple times in a row.
+     */
+    std::array<std::vector<RVec>, 2>  x;
+    std::array<PaddedVector<RVec>, 2> f;
+    for (int b = 0; b < 2; b++)
+    {
+        x[b].resize(numAtomsTotal);
+        f[b].resizeWithPadding(numAtomsTotal);
+    }
+    for (int b : { 0, 0, 1, 0, 1 })
+    {
+        initHaloData(x[b].data(), numHomeAtoms, numAtomsTotal);
+        dd_move_x(dd, box, x[b], nullptr);
+        for (int i = 0; i < numAtomsTotal; i++)
+        {
+            for (int j = 0; j < DIM; j++)
+            {
+                EXPECT_EQ(xReference[i][j], x[b][i][j])
+                        << "for atom " << i << " in buffer " << b << " on rank " << dd->rank;
+            }
+        }
+
+        initHaloData(f[b].data(), numAtomsTotal, numAtomsTotal);
+        ForceWithShiftForces directForces(f[b].arrayRefWithPadding(), false, {});
+        dd_move_f(dd, &directForces, nullptr);
+        for (int i = 0; i < numHomeAtoms; i++)
+        {
+            for (int j = 0; j < DIM; j++)
+            {
+                EXPECT_EQ(fReference[i][j], f[b][i][j])
+                        << "for atom " << i << " in buffer " << b << " on rank " << dd->rank;
+            }
+        }
+    }
+
+    dd->comm->ddSettings.useDirectHaloExchange = false;
+}
+
 } // namespace
 } // namespace test
 } // namespace gmx
@@ -44,6 +44,7 @@
 #include <cstring>
 #include <ctime>
 
+#include <algorithm>
 #include <memory>
 
 #include "gromacs/commandline/filenm.h"
@@ -59,6 +60,7 @@
 #include "gromacs/math/vectypes.h"
 #include "gromacs/mdlib/broadcaststructs.h"
 #include "gromacs/mdlib/constr.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
 #include "gromacs/mdlib/groupcoord.h"
 #include "gromacs/mdlib/stat.h"
 #include "gromacs/mdlib/update.h"
@@ -73,6 +75,7 @@
 #include "gromacs/topology/mtop_lookup.h"
 #include "gromacs/topology/topology.h"
 #include "gromacs/utility/cstringutil.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/gmxassert.h"
 #include "gromacs/utility/logger.h"
@@ -376,6 +379,21 @@ static char get_EDgroupChar(int nr_edi, int nED)
 
 namespace
 {
+/*! \brief The minimum number of atom times eigenvector products per OpenMP thread
+ * for projections and flooding forces */
+constexpr int c_minAtomEigenvectorProductsPerThread = 20000;
+
+/*! \brief Returns the number of OpenMP threads to use for work over \p numItems
+ * eigenvectors or atoms, where each item involves \p workPerItem products.
+ */
+int numThreadsForEigenvectorWork(int numItems, int workPerItem)
+{
+    const int64_t work       = static_cast<int64_t>(numItems) * workPerItem;
+    const int     maxThreads = std::max(1, std::min(numItems, gmx_omp_nthreads_get(emntDefault)));
+    return static_cast<int>(
+            std::clamp<int64_t>(work / c_minAtomEigenvectorProductsPerThread, 1, maxThreads));
+}
+
 /*! \brief The mass-weighted inner product of two coordinate vectors.
  * Does not subtract average positions, projection on single eigenvector is returned
  * used by: do_linfix, do_linacc, do_radfix, do_radacc, do_radcon
@@ -417,9 +435,14 @@ void rad_project(const t_edpar& edi, rvec* x, t_eigvec* vec)
         rvec_dec(x[i], edi.sav.x[i]);
     }
 
+    const int numThreads = numThreadsForEigenvectorWork(vec->neig, edi.sav.nr);
+#pragma omp parallel for num_threads(numThreads) schedule(static)
     for (i = 0; i < vec->neig; i++)
     {
         vec->refproj[i] = projectx(edi, x, vec->vec[i]);
+    }
+    for (i = 0; i < vec->neig; i++)
+    {
         rad += gmx::square((vec->refproj[i] - vec->xproj[i]));
     }
     vec->radius = sqrt(rad);
@@ -451,6 +474,10 @@ void project_to_eigvectors(rvec* x, t_eigvec* vec, const t_edpar& edi)
         rvec_dec(x[i], edi.sav.x[i]);
     }
 
+    /* Each eigenvector is projected by a single thread, so the result does
+     * not depend on the number of threads */
+    const int numThreads = numThreadsForEigenvectorWork(vec->neig, edi.sav.nr);
+#pragma omp parallel for num_threads(numThreads) schedule(static)
     for (int i = 0; i < vec->neig; i++)
     {
         vec->xproj[i] = projectx(edi, x, vec->vec[i]);
@@ -856,15 +883,13 @@ void flood_blowup(const t_edpar& edi, rvec* forces_cart)
     const real* forces_sub = edi.flood.vecs.fproj;
     /* Calculate the cartesian forces for the local atoms */
 
-    /* Clear forces first */
+    /* Now compute atomwise */
+    const int numThreads = numThreadsForEigenvectorWork(edi.sav.nr_loc, edi.flood.vecs.neig);
+#pragma omp parallel for num_threads(numThreads) schedule(static)
     for (int j = 0; j < edi.sav.nr_loc; j++)
     {
         clear_rvec(forces_cart[j]);
-    }
 
-    /* Now compute atomwise */
-    for (int j = 0; j < edi.sav.nr_loc; j++)
-    {
         /* Compute forces_cart[edi.sav.anrs[j]] */
         for (int eig = 0; eig < edi.flood.vecs.neig; eig++)
         {
@@ -63,8 +63,10 @@
 #include "gromacs/topology/topology.h"
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/cstringutil.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/stringutil.h"
 
@@ -1431,7 +1433,7 @@ int gmx_cluster(int argc, char* argv[])
 
     matrix      box;
     matrix*     boxes = nullptr;
-    rvec *      xtps, *usextps, *x1, **xx = nullptr;
+    rvec *      xtps, *usextps, **x1, **xx = nullptr;
     const char *fn, *trx_out_fn;
     t_clusters  clust;
     t_mat *     rms, *orig = nullptr;
@@ -1444,7 +1446,7 @@ int gmx_cluster(int argc, char* argv[])
     int      isize = 0, ifsize = 0, iosize = 0;
     int *    index = nullptr, *fitidx = nullptr, *outidx = nullptr, *frameindices = nullptr;
     char*    grpname;
-    real     rmsd, **d1, **d2, *time = nullptr, time_invfac, *mass = nullptr;
+    real **  d1, ***d2, *time = nullptr, time_invfac, *mass = nullptr;
     char     buf[STRLEN], buf1[80];
     gmx_bool bAnalyze, bUseRmsdCut, bJP_RMSD = FALSE, bReadMat, bReadTraj, bPBC = TRUE;
 
@@ -1787,25 +1789,40 @@ int gmx_cluster(int argc, char* argv[])
     {
         rms  = init_mat(nf, method == m_diagonalize);
         nrms = (static_cast<int64_t>(nf) * static_cast<int64_t>(nf - 1)) / 2;
+        const int nthreads = gmx_omp_get_max_threads();
         if (!bRMSdist)
         {
             fprintf(stderr, "Computing %dx%d RMS deviation matrix\n", nf, nf);
-            /* Initialize work array */
-            snew(x1, isize);
+            /* Initialize work arrays, one for each thread */
+            snew(x1, nthreads);
+            for (i = 0; i < nthreads; i++)
+            {
+                snew(x1[i], isize);
+            }
             for (i1 = 0; i1 < nf; i1++)
             {
+#pragma omp parallel for num_threads(nthreads) schedule(static)
                 for (i2 = i1 + 1; i2 < nf; i2++)
                 {
-                    for (i = 0; i < isize; i++)
+                    try
                     {
-                        copy_rvec(xx[i1][i], x1[i]);
-                    }
-                    if (bFit)
-                    {
-                        do_fit(isize, mass, xx[i2], x1);
+                        rvec* x1Thread = x1[gmx_omp_get_thread_num()];
+                        for (int a = 0; a < isize; a++)
+                        {
+                            copy_rvec(xx[i1][a], x1Thread[a]);
+                        }
+                        if (bFit)
+                        {
+                            do_fit(isize, mass, xx[i2], x1Thread);
+                        }
+                        rms->mat[i1][i2] = rmsdev(isize, mass, xx[i2], x1Thread);
                     }
-                    rmsd = rmsdev(isize, mass, xx[i2], x1);
-                    set_mat_entry(rms, i1, i2, rmsd);
+                    GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+                }
+                /* Set the entries in order, so the sum does not depend on the threads */
+                for (i2 = i1 + 1; i2 < nf; i2++)
+                {
+                    set_mat_entry(rms, i1, i2, rms->mat[i1][i2]);
                 }
                 nrms -= nf - i1 - 1;
                 fprintf(stderr,
@@ -1814,27 +1831,48 @@ int gmx_cluster(int argc, char* argv[])
                         nrms);
                 fflush(stderr);
             }
+            for (i = 0; i < nthreads; i++)
+            {
+                sfree(x1[i]);
+            }
             sfree(x1);
         }
         else /* bRMSdist */
         {
             fprintf(stderr, "Computing %dx%d RMS distance deviation matrix\n", nf, nf);
 
-            /* Initiate work arrays */
+            /* Initiate work arrays, d2 for each thread */
             snew(d1, isize);
-            snew(d2, isize);
             for (i = 0; (i < isize); i++)
             {
                 snew(d1[i], isize);
-                snew(d2[i], isize);
+            }
+            snew(d2, nthreads);
+            for (j = 0; j < nthreads; j++)
+            {
+                snew(d2[j], isize);
+                for (i = 0; (i < isize); i++)
+                {
+                    snew(d2[j][i], isize);
+                }
             }
             for (i1 = 0; i1 < nf; i1++)
             {
                 calc_dist(isize, xx[i1], d1);
-                for (i2 = i1 + 1; (i2 < nf); i2++)
+#pragma omp parallel for num_threads(nthreads) schedule(static)
+                for (i2 = i1 + 1; i2 < nf; i2++)
+                {
+                    try
+                    {
+                        real** d2Thread = d2[gmx_omp_get_thread_num()];
+                        calc_dist(isize, xx[i2], d2Thread);
+                        rms->mat[i1][i2] = rms_dist(isize, d1, d2Thread);
+                    }
+                    GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+                }
+                for (i2 = i1 + 1; i2 < nf; i2++)
                 {
-                    calc_dist(isize, xx[i2], d2);
-                    set_mat_entry(rms, i1, i2, rms_dist(isize, d1, d2));
+                    set_mat_entry(rms, i1, i2, rms->mat[i1][i2]);
                 }
                 nrms -= nf - i1 - 1;
                 fprintf(stderr,
@@ -1847,9 +1885,16 @@ int gmx_cluster(int argc, char* argv[])
             for (i = 0; (i < isize); i++)
             {
                 sfree(d1[i]);
-                sfree(d2[i]);
             }
             sfree(d1);
+            for (j = 0; j < nthreads; j++)
+            {
+                for (i = 0; (i < isize); i++)
+                {
+                    sfree(d2[j][i]);
+                }
+                sfree(d2[j]);
+            }
             sfree(d2);
         }
         fprintf(stderr, "\n\n");
@@ -58,9 +58,40 @@
 #include "gromacs/utility/cstringutil.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/sysinfo.h"
 
+/* The number of frames whose deviations are added to the covariance matrix together */
+static const int c_covarFramesPerBatch = 32;
+
+/* Adds the products of the deviations of nbatch frames, stored consecutively
+ * in xbatch, to the upper triangle of the ndim x ndim matrix mat. Each row is
+ * updated with all frames while it is in cache, and the rows are distributed
+ * over OpenMP threads. The frames are added to each element in order, so the
+ * result does not depend on the batching or the number of threads.
+ */
+static void add_to_covariance(real* mat, int64_t ndim, const rvec* xbatch, int nbatch)
+{
+    const int64_t natoms = ndim / DIM;
+
+#pragma omp parallel for num_threads(gmx_omp_get_max_threads()) schedule(dynamic)
+    for (int64_t row = 0; row < ndim; row++)
+    {
+        real*         matRow      = mat + ndim * row;
+        const int64_t columnStart = DIM * (row / DIM);
+        for (int f = 0; f < nbatch; f++)
+        {
+            const real* x  = xbatch[natoms * f];
+            const real  xj = x[row];
+            for (int64_t column = columnStart; column < ndim; column++)
+            {
+                matRow[column] += x[column] * xj;
+            }
+        }
+    }
+}
+
 int gmx_covar(int argc, char* argv[])
 {
     const char* desc[] = {
@@ -116,14 +147,14 @@ int gmx_covar(int argc, char* argv[])
     t_topology        top;
     PbcType           pbcType;
     t_atoms*          atoms;
-    rvec *            x, *xread, *xref, *xav, *xproj;
+    rvec *            x, *xbatch, *xread, *xref, *xav, *xproj;
     matrix            box, zerobox;
     real *            sqrtm, *mat, *eigenvalues, sum, trace, inv_nframes;
     real              t, tstart, tend, **mat2;
-    real              xj, *w_rls = nullptr;
+    real*             w_rls = nullptr;
     real              min, max, *axis;
-    int               natoms, nat, nframes0, nframes, nlevels;
-    int64_t           ndim, i, j, k, l;
+    int               natoms, nat, nframes0, nframes, nbatch, nlevels;
+    int64_t           ndim, i, j, k;
     int               WriteXref;
     const char *      fitfile, *trxfile, *ndxfile;
     const char *      eigvalfile, *eigvecfile, *averfile, *logfile;
@@ -248,6 +279,7 @@ int gmx_covar(int argc, char* argv[])
     }
 
     snew(x, natoms);
+    snew(xbatch, c_covarFramesPerBatch * natoms);
     snew(xav, natoms);
     ndim = natoms * DIM;
     if (std::sqrt(static_cast<real>(INT64_MAX)) < static_cast<real>(ndim))
@@ -300,6 +332,7 @@ int gmx_covar(int argc, char* argv[])
     fprintf(stderr, "Constructing covariance matrix (%dx%d) ...\n", static_cast<int>(ndim),
             static_cast<int>(ndim));
     nframes = 0;
+    nbatch  = 0;
     nat     = read_first_x(oenv, &status, trxfile, &t, &xread, box);
     tstart  = t;
     do
@@ -316,39 +349,32 @@ int gmx_covar(int argc, char* argv[])
             reset_x(nfit, ifit, nat, nullptr, xread, w_rls);
             do_fit(nat, w_rls, xref, xread);
         }
+        rvec* xdev = xbatch + natoms * nbatch;
         if (bRef)
         {
             for (i = 0; i < natoms; i++)
             {
-                rvec_sub(xread[index[i]], xref[index[i]], x[i]);
+                rvec_sub(xread[index[i]], xref[index[i]], xdev[i]);
             }
         }
         else
         {
             for (i = 0; i < natoms; i++)
             {
-                rvec_sub(xread[index[i]], xav[i], x[i]);
+                rvec_sub(xread[index[i]], xav[i], xdev[i]);
             }
         }
 
-        for (j = 0; j < natoms; j++)
+        nbatch++;
+        if (nbatch == c_covarFramesPerBatch)
         {
-            for (dj = 0; dj < DIM; dj++)
-            {
-                k  = ndim * (DIM * j + dj);
-                xj = x[j][dj];
-                for (i = j; i < natoms; i++)
-                {
-                    l = k + DIM * i;
-                    for (d = 0; d < DIM; d++)
-                    {
-                        mat[l + d] += x[i][d] * xj;
-                    }
-                }
-            }
+            add_to_covariance(mat, ndim, xbatch, nbatch);
+            nbatch = 0;
         }
     } while (read_next_x(oenv, status, &t, xread, box) && (bRef || nframes < nframes0));
     close_trx(status);
+    add_to_covariance(mat, ndim, xbatch, nbatch);
+    sfree(xbatch);
     gmx_rmpbc_done(gpbc);
 
     fprintf(stderr, "Read %d frames\n", nframes);
@@ -45,6 +45,7 @@
 
 #include <algorithm>
 #include <numeric>
+#include <vector>
 
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/commandline/viewit.h"
@@ -162,6 +163,14 @@ typedef struct
      */
 } t_hbond;
 
+/* A hydrogen bond or contact found by one thread, stored until it is added
+ * to the shared hbond data by the thread that owns its donor.
+ */
+typedef struct
+{
+    int d, a, h, grpd, grpa, ihb;
+} t_hbfound;
+
 typedef struct
 {
     int  nra, max_nra;
@@ -323,12 +332,12 @@ static void add_ff(t_hbdata* hbd, int id, int h, int ia, int frame, int ihb)
     else
     {
         hb->nframes = frame - hb->n0;
-        /* We need a while loop here because hbonds may be returning
-         * after a long time.
+        /* Hbonds may be returning after a long time, so grow the arrays
+         * to fit the current frame in a single reallocation.
          */
-        while (hb->nframes >= hb->maxframes)
+        if (hb->nframes >= hb->maxframes)
         {
-            n = hb->maxframes + delta;
+            n = hb->maxframes + ((hb->nframes - hb->maxframes) / delta + 1) * delta;
             for (i = 0; (i < maxhydro); i++)
             {
                 srenew(hb->h[i], n / wlen);
@@ -509,21 +518,13 @@ add_hbond(t_hbdata* hb, int d, int a, int h, int grpd, int grpa, int frame, gmx_
 
         if (hb->bHBmap)
         {
-
-#pragma omp critical
+            if (hb->hbmap[id][ia] == nullptr)
             {
-                try
-                {
-                    if (hb->hbmap[id][ia] == nullptr)
-                    {
-                        snew(hb->hbmap[id][ia], 1);
-                        snew(hb->hbmap[id][ia]->h, hb->maxhydro);
-                        snew(hb->hbmap[id][ia]->g, hb->maxhydro);
-                    }
-                    add_ff(hb, id, k, ia, frame, ihb);
-                }
-                GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+                snew(hb->hbmap[id][ia], 1);
+                snew(hb->hbmap[id][ia]->h, hb->maxhydro);
+                snew(hb->hbmap[id][ia]->g, hb->maxhydro);
             }
+            add_ff(hb, id, k, ia, frame, ihb);
         }
 
         /* Strange construction with frame >=0 is a relic from old code
@@ -584,6 +585,21 @@ add_hbond(t_hbdata* hb, int d, int a, int h, int grpd, int grpa, int frame, gmx_
     }
 }
 
+/* Returns the thread, out of nthreads, that adds hbonds between donor d and
+ * acceptor a to the shared hbond map. This is based on the donor that
+ * add_hbond() uses, so each row of the map is only modified by one thread.
+ */
+static int hbond_owner_thread(t_hbdata* hb, int d, int a, int grpd, int grpa, gmx_bool bMerge, int nthreads)
+{
+    if (bMerge && isInterchangable(hb, d, a, grpd, grpa) && d > a)
+    {
+        d = a;
+    }
+    const int id = hb->d.dptr[d];
+
+    return static_cast<int>((static_cast<int64_t>(id) * nthreads) / hb->d.nrd);
+}
+
 static char* mkatomname(const t_atoms* atoms, int i)
 {
     static char buf[32];
@@ -2629,6 +2645,8 @@ int gmx_hbond(int argc, char* argv[])
 
     t_hbdata** p_hb    = nullptr; /* one per thread, then merge after the frame loop */
     int **     p_adist = nullptr, **p_rdist = nullptr; /* a histogram for each thread. */
+    /* hbonds found by each thread, for each owner thread (see hbond_owner_thread()) */
+    std::vector<std::vector<std::vector<t_hbfound>>> p_found;
 
     const bool bOMP = GMX_OPENMP;
 
@@ -2885,6 +2903,7 @@ int gmx_hbond(int argc, char* argv[])
             actual_nThreads = 1;
         }
 
+        p_found.resize(actual_nThreads, std::vector<std::vector<t_hbfound>>(actual_nThreads));
         snew(p_hb, actual_nThreads);
         snew(p_adist, actual_nThreads);
         snew(p_rdist, actual_nThreads);
@@ -3068,8 +3087,20 @@ int gmx_hbond(int argc, char* argv[])
                                                         {
                                                             /* add to index if not already there */
                                                             /* Add a hbond */
-                                                            add_hbond(__HBDATA, i, j, h, grp, ogrp,
-                                                                      nframes, bMerge, ihb, bContact);
+                                                            if (bOMP)
+                                                            {
+                                                                /* Added by the owner thread after the search */
+                                                                const int owner = hbond_owner_thread(
+                                                                        hb, i, j, grp, ogrp, bMerge,
+                                                                        actual_nThreads);
+                                                                p_found[threadNr][owner].push_back(
+                                                                        { i, j, h, grp, ogrp, ihb });
+                                                            }
+                                                            else
+                                                            {
+                                                                add_hbond(__HBDATA, i, j, h, grp, ogrp,
+                                                                          nframes, bMerge, ihb, bContact);
+                                                            }
 
                                                             /* make angle and distance distributions */
                                                             if (ihb == hbHB && !bContact)
@@ -3124,6 +3155,26 @@ int gmx_hbond(int argc, char* argv[])
                     }
                     GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
                 }
+
+                if (bOMP)
+                {
+                    /* Add the hbonds with the donors owned by this thread,
+                     * which avoids serializing the updates of the hbond map.
+                     */
+                    try
+                    {
+                        for (auto& threadFound : p_found)
+                        {
+                            for (const t_hbfound& f : threadFound[threadNr])
+                            {
+                                add_hbond(__HBDATA, f.d, f.a, f.h, f.grpd, f.grpa, nframes, bMerge,
+                                          f.ihb, bContact);
+                            }
+                            threadFound[threadNr].clear();
+                        }
+                    }
+                    GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+                }
             } /* if (bSelected) {...} else */
 
 
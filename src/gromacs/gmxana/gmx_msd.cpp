@@ -40,6 +40,7 @@
 #include <cmath>
 #include <cstring>
 
+#include <algorithm>
 #include <memory>
 
 #include "gromacs/commandline/pargs.h"
@@ -58,9 +59,11 @@
 #include "gromacs/topology/index.h"
 #include "gromacs/topology/topology.h"
 #include "gromacs/utility/arraysize.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
 static constexpr double diffusionConversionFactor = 1000.0; /* Convert nm^2/ps to 10e-5 cm^2/s */
@@ -234,6 +237,19 @@ static void corr_print(t_corr*                 curr,
     xvgrclose(out);
 }
 
+/* The minimum number of atoms or molecules times starting points per thread */
+static const int c_msdMinWorkPerThread = 10000;
+
+/* Returns the number of threads to use for computing the displacements
+ * of nx atoms or molecules from nrestart starting points */
+static int msd_num_threads(int nrestart, int nx)
+{
+    const int64_t work = static_cast<int64_t>(nrestart) * nx;
+
+    return static_cast<int>(std::max<int64_t>(
+            1, std::min<int64_t>(gmx_omp_get_max_threads(), work / c_msdMinWorkPerThread)));
+}
+
 /* called from corr_loop, to do the main calculations */
 static void
 calc_corr(t_corr* curr, int nr, int nx, int index[], rvec xc[], gmx_bool bRmCOMM, rvec com, t_calc_func* calc1, gmx_bool bTen)
@@ -257,27 +273,35 @@ calc_corr(t_corr* curr, int nr, int nx, int index[], rvec xc[], gmx_bool bRmCOMM
 
     /* nx0 appears to be the number of new starting points,
      * so for all starting points, call calc1.
+     * Each starting point contributes to a different data point,
+     * so they can be processed in parallel.
      */
-    for (nx0 = 0; (nx0 < curr->nlast); nx0++)
+    const int numThreads = msd_num_threads(curr->nlast, nx);
+#pragma omp parallel for num_threads(numThreads) schedule(static) private(g, mat, dcom)
+    for (nx0 = 0; nx0 < curr->nlast; nx0++)
     {
-        if (bRmCOMM)
+        try
         {
-            rvec_sub(com, curr->com[nx0], dcom);
-        }
-        else
-        {
-            clear_rvec(dcom);
-        }
-        g = calc1(curr, nx, index, nx0, xc, dcom, bTen, mat);
+            if (bRmCOMM)
+            {
+                rvec_sub(com, curr->com[nx0], dcom);
+            }
+            else
+            {
+                clear_rvec(dcom);
+            }
+            g = calc1(curr, nx, index, nx0, xc, dcom, bTen, mat);
 #ifdef DEBUG2
-        printf("g[%d]=%g\n", nx0, g);
+            printf("g[%d]=%g\n", nx0, g);
 #endif
-        curr->data[nr][in_data(curr, nx0)] += g;
-        if (bTen)
-        {
-            m_add(curr->datam[nr][in_data(curr, nx0)], mat, curr->datam[nr][in_data(curr, nx0)]);
+            curr->data[nr][in_data(curr, nx0)] += g;
+            if (bTen)
+            {
+                m_add(curr->datam[nr][in_data(curr, nx0)], mat, curr->datam[nr][in_data(curr, nx0)]);
+            }
+            curr->ndata[nr][in_data(curr, nx0)]++;
         }
-        curr->ndata[nr][in_data(curr, nx0)]++;
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
     }
 }
 
@@ -0,0 +1,103 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for gmx covar.
+ */
+#include "gmxpre.h"
+
+#include "gromacs/gmxana/gmx_ana.h"
+
+#include "testutils/cmdlinetest.h"
+#include "testutils/filematchers.h"
+#include "testutils/refdata.h"
+#include "testutils/stdiohelper.h"
+#include "testutils/textblockmatchers.h"
+#include "testutils/xvgtest.h"
+
+namespace
+{
+
+using gmx::test::CommandLine;
+using gmx::test::NoContentsMatch;
+using gmx::test::NoTextMatch;
+using gmx::test::StdioTestHelper;
+using gmx::test::XvgMatch;
+
+class CovarTest : public gmx::test::CommandLineTestBase
+{
+public:
+    CovarTest()
+    {
+        setInputFile("-f", "covar_traj.gro");
+        setInputFile("-s", "spc2.gro");
+        // The smallest eigenvalues only reflect rounding of the input
+        // coordinates, so compare against the size of the largest ones.
+        setOutputFile("-o", "eigenval.xvg", XvgMatch().tolerance(gmx::test::absoluteTolerance(1e-6)));
+        setOutputFile("-v", "eigenvec.trr", NoContentsMatch());
+        setOutputFile("-av", "average.gro", NoTextMatch());
+        setOutputFile("-l", "covar.log", NoTextMatch());
+    }
+
+    void runTest(const CommandLine& args)
+    {
+        StdioTestHelper stdioHelper(&fileManager());
+        stdioHelper.redirectStringToStdin("0\n0\n");
+
+        CommandLine& cmdline = commandLine();
+        cmdline.merge(args);
+        ASSERT_EQ(0, gmx_covar(cmdline.argc(), cmdline.argv()));
+        checkOutputFiles();
+    }
+};
+
+/* covar_traj.gro has five frames of the two SPC waters in spc2.gro
+ * with small, deterministic displacements of all atoms. */
+
+/* With the default fit and identical fit and analysis groups,
+ * the reference structure is written to the eigenvector file. */
+TEST_F(CovarTest, WorksWithFit)
+{
+    const char* const cmdline[] = { "covar" };
+    runTest(CommandLine(cmdline));
+}
+
+TEST_F(CovarTest, WorksWithoutFit)
+{
+    const char* const cmdline[] = { "covar", "-nofit" };
+    runTest(CommandLine(cmdline));
+}
+
+} // namespace
@@ -52,6 +52,9 @@
 #include "gromacs/math/functions.h"
 #include "gromacs/math/multidimarray.h"
 #include "gromacs/math/utilities.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxassert.h"
 
 namespace gmx
 {
@@ -317,16 +320,32 @@ public:
     Impl& operator=(const Impl& other) = default;
     //! Add another gaussian
     void add(const GaussianSpreadKernelParameters::PositionAndAmplitude& localParamters);
+    //! \copydoc GaussTransform3D::add(ArrayRef<const RVec>, ArrayRef<const real>, int)
+    void add(ArrayRef<const RVec> coordinates, ArrayRef<const real> amplitudes, int numThreads);
+
+    //! Scratch memory for evaluating the Gaussian that is added to the lattice
+    struct SpreadWork
+    {
+        //! The outer product of a Gaussian along the z and y dimension
+        OuterProductEvaluator outerProductZY_;
+        //! The three one-dimensional Gaussians, whose outer product is added to the Gauss transform
+        std::array<GaussianOn1DLattice, DIM> gauss1d_;
+    };
+    /*! \brief Add a gaussian only to the lattice planes [planeBegin, planeEnd) along z
+     * using the given scratch memory
+     */
+    void addWithinPlanes(const GaussianSpreadKernelParameters::PositionAndAmplitude& localParameters,
+                         int                                                         planeBegin,
+                         int                                                         planeEnd,
+                         SpreadWork*                                                 work);
     //! The width of the Gaussian in lattice spacing units
     BasicVector<double> sigma_;
     //! The spread range in lattice points
     IVec spreadRange_;
     //! The result of the Gauss transform
     MultiDimArray<std::vector<float>, dynamicExtents3D> data_;
-    //! The outer product of a Gaussian along the z and y dimension
-    OuterProductEvaluator outerProductZY_;
-    //! The three one-dimensional Gaussians, whose outer product is added to the Gauss transform
-    std::array<GaussianOn1DLattice, DIM> gauss1d_;
+    //! Spreading scratch memory, one entry per thread, always at least one entry
+    std::vector<SpreadWork> work_;
 };
 
 GaussTransform3D::Impl::Impl(const dynamicExtents3D&                      extent,
@@ -334,39 +353,82 @@ GaussTransform3D::Impl::Impl(const dynamicExtents3D&                      extent
     sigma_{ kernelShapeParameters.sigma_ },
     spreadRange_{ kernelShapeParameters.latticeSpreadRange() },
     data_{ extent },
-    gauss1d_({ GaussianOn1DLattice(spreadRange_[XX], sigma_[XX]),
-               GaussianOn1DLattice(spreadRange_[YY], sigma_[YY]),
-               GaussianOn1DLattice(spreadRange_[ZZ], sigma_[ZZ]) })
+    work_({ SpreadWork{ OuterProductEvaluator(),
+                        { GaussianOn1DLattice(spreadRange_[XX], sigma_[XX]),
+                          GaussianOn1DLattice(spreadRange_[YY], sigma_[YY]),
+                          GaussianOn1DLattice(spreadRange_[ZZ], sigma_[ZZ]) } } })
 {
 }
 
 void GaussTransform3D::Impl::add(const GaussianSpreadKernelParameters::PositionAndAmplitude& localParameters)
+{
+    addWithinPlanes(localParameters, 0, data_.asView().extent(0), &work_[0]);
+}
+
+void GaussTransform3D::Impl::add(ArrayRef<const RVec> coordinates, ArrayRef<const real> amplitudes, int numThreads)
+{
+    GMX_ASSERT(coordinates.size() == amplitudes.size(),
+               "Need exactly one amplitude per coordinate when spreading.");
+
+    const int numPlanes = data_.asView().extent(0);
+    numThreads          = std::max(1, std::min(numThreads, numPlanes));
+    if (ssize(work_) < numThreads)
+    {
+        work_.resize(numThreads, work_[0]);
+    }
+
+    // Each thread owns a contiguous block of z-planes and loops over all Gaussians,
+    // so every lattice value is summed in the same order as with a single thread
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int thread = 0; thread < numThreads; thread++)
+    {
+        try
+        {
+            const int planeBegin = (thread * numPlanes) / numThreads;
+            const int planeEnd   = ((thread + 1) * numPlanes) / numThreads;
+            for (gmx::index i = 0; i < ssize(coordinates); i++)
+            {
+                addWithinPlanes({ coordinates[i], amplitudes[i] }, planeBegin, planeEnd, &work_[thread]);
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+}
+
+void GaussTransform3D::Impl::addWithinPlanes(const GaussianSpreadKernelParameters::PositionAndAmplitude& localParameters,
+                                             int         planeBegin,
+                                             int         planeEnd,
+                                             SpreadWork* work)
 {
     const IVec closestLatticePoint = closestIntegerPoint(localParameters.coordinate_);
     const auto spreadRange =
             spreadRangeWithinLattice(closestLatticePoint, data_.asView().extents(), spreadRange_);
+    const int zBegin = std::max(spreadRange.begin()[ZZ], planeBegin);
+    const int zEnd   = std::min(spreadRange.end()[ZZ], planeEnd);
 
-    // do nothing if the added Gaussian will never reach the lattice
-    if (spreadRange.empty())
+    // do nothing if the added Gaussian will never reach the lattice or the requested planes
+    if (spreadRange.empty() || zBegin >= zEnd)
     {
         return;
     }
 
+    std::array<GaussianOn1DLattice, DIM>& gauss1d = work->gauss1d_;
+
     for (int dimension = XX; dimension <= ZZ; ++dimension)
     {
         // multiply with amplitude so that Gauss3D = (amplitude * Gauss_x) * Gauss_y * Gauss_z
         const float gauss1DAmplitude = dimension > XX ? 1.0 : localParameters.amplitude_;
-        gauss1d_[dimension].spread(gauss1DAmplitude, localParameters.coordinate_[dimension]
-                                                             - closestLatticePoint[dimension]);
+        gauss1d[dimension].spread(gauss1DAmplitude, localParameters.coordinate_[dimension]
+                                                            - closestLatticePoint[dimension]);
     }
 
-    const auto spreadZY         = outerProductZY_(gauss1d_[ZZ].view(), gauss1d_[YY].view());
-    const auto spreadX          = gauss1d_[XX].view();
+    const auto spreadZY         = work->outerProductZY_(gauss1d[ZZ].view(), gauss1d[YY].view());
+    const auto spreadX          = gauss1d[XX].view();
     const IVec spreadGridOffset = spreadRange_ - closestLatticePoint;
 
     // \todo optimize these loops if performance critical
     // The looping strategy uses that the last, x-dimension is contiguous in the memory layout
-    for (int zLatticeIndex = spreadRange.begin()[ZZ]; zLatticeIndex < spreadRange.end()[ZZ]; ++zLatticeIndex)
+    for (int zLatticeIndex = zBegin; zLatticeIndex < zEnd; ++zLatticeIndex)
     {
         const auto zSlice = data_.asView()[zLatticeIndex];
 
@@ -401,6 +463,11 @@ void GaussTransform3D::add(const GaussianSpreadKernelParameters::PositionAndAmpl
     impl_->add(localParameters);
 }
 
+void GaussTransform3D::add(ArrayRef<const RVec> coordinates, ArrayRef<const real> amplitudes, int numThreads)
+{
+    impl_->add(coordinates, amplitudes, numThreads);
+}
+
 void GaussTransform3D::setZero()
 {
     std::fill(begin(impl_->data_), end(impl_->data_), 0.);
@@ -193,6 +193,19 @@ public:
      */
     void add(const GaussianSpreadKernelParameters::PositionAndAmplitude& localParameters);
 
+    /*! \brief Add three dimensional Gaussians with given amplitudes at a set of coordinates.
+     *
+     * The lattice planes along the slowest varying dimension are divided into
+     * \p numThreads contiguous blocks that are filled by separate OpenMP threads.
+     * Every lattice value accumulates its contributions in the order of \p coordinates,
+     * so the result is identical to calling add() for each coordinate in turn.
+     *
+     * \param[in] coordinates of the Gaussian centers
+     * \param[in] amplitudes of the Gaussians, one per coordinate
+     * \param[in] numThreads the number of OpenMP threads to use
+     */
+    void add(ArrayRef<const RVec> coordinates, ArrayRef<const real> amplitudes, int numThreads);
+
     //! \brief Set all values on the lattice to zero.
     void setZero();
 
@@ -43,6 +43,7 @@
 
 #include "gromacs/math/gausstransform.h"
 
+#include <algorithm>
 #include <array>
 #include <numeric>
 #include <vector>
@@ -279,6 +280,30 @@ TEST_F(GaussTransformTest, view)
     EXPECT_THAT(expectedValues, testing::Pointwise(FloatEq(tolerance_), gaussTransformVector));
 }
 
+TEST(GaussTransformThreaded, addingManyIsIndependentOfThreadCount)
+{
+    const extents<dynamic_extent, dynamic_extent, dynamic_extent> latticeExtent = { 7, 7, 7 };
+    const GaussianSpreadKernelParameters::Shape kernelShape = { DVec{ 1., 1., 1. }, 3 };
+    const std::vector<RVec> coordinates = { { 0, 0, 0 },     { 3.2, 2.7, 3.1 }, { 6.4, 1.1, 5.9 },
+                                            { 2.5, 4.5, 0.2 }, { 1.3, 6.8, 3.5 }, { 5.1, 3.3, -1.7 } };
+    const std::vector<real> amplitudes = { 1.0, 0.5, -0.3, 2.0, 0.7, 1.1 };
+
+    GaussTransform3D expected(latticeExtent, kernelShape);
+    for (size_t i = 0; i < coordinates.size(); i++)
+    {
+        expected.add({ coordinates[i], amplitudes[i] });
+    }
+
+    for (int numThreads : { 1, 2, 3, 7, 9 })
+    {
+        GaussTransform3D threaded(latticeExtent, kernelShape);
+        threaded.add(coordinates, amplitudes, numThreads);
+        EXPECT_TRUE(std::equal(begin(expected.constView()), end(expected.constView()),
+                               begin(threaded.constView())))
+                << "with " << numThreads << " threads";
+    }
+}
+
 } // namespace
 
 } // namespace test
@@ -1228,6 +1228,14 @@ void do_force(FILE*                               fplog,
     const bool haveHostHaloExchangeComms =
             havePPDomainDecomposition(cr) && !simulationWork.useGpuHaloExchange;
 
+    /* With CPU non-bondeds and a non-blocking halo exchange, we can compute
+     * the local non-bonded forces while the halo coordinates are in flight,
+     * and compute PME and special forces while the halo forces are in flight.
+     */
+    const bool overlapHaloExchangeWithCpuCompute =
+            haveHostHaloExchangeComms && dd_haloExchangeCanOverlapCompute(*cr->dd)
+            && !(simulationWork.useGpuNonbonded || fr->nbv->emulateGpu()) && !fr->useMts;
+
     bool gmx_used_in_debug haveCopiedXFromGpu = false;
     if (simulationWork.useGpuUpdate && !stepWork.doNeighborSearch
         && (runScheduleWork->domainWork.haveCpuLocalForceWork || stepWork.computeVirial
@@ -1496,7 +1504,14 @@ void do_force(FILE*                               fplog,
                                "a wait should only be triggered if copy has been scheduled");
                     stateGpu->waitCoordinatesReadyOnHost(AtomLocality::Local);
                 }
-                dd_move_x(cr->dd, box, x.unpaddedArrayRef(), wcycle);
+                if (overlapHaloExchangeWithCpuCompute)
+                {
+                    dd_move_x_start(cr->dd, box, x.unpaddedArrayRef(), wcycle);
+                }
+                else
+                {
+                    dd_move_x(cr->dd, box, x.unpaddedArrayRef(), wcycle);
+                }
             }
 
             if (stepWork.useGpuXBufferOps)
@@ -1509,7 +1524,7 @@ void do_force(FILE*                               fplog,
                                            stateGpu->getCoordinatesReadyOnDeviceEvent(
                                                    AtomLocality::NonLocal, simulationWork, stepWork));
             }
-            else
+            else if (!overlapHaloExchangeWithCpuCompute)
             {
                 nbv->convertCoordinates(AtomLocality::NonLocal, false, x.unpaddedArrayRef());
             }
@@ -1661,6 +1676,15 @@ void do_force(FILE*                               fplog,
         do_nb_verlet(fr, ic, enerd, stepWork, InteractionLocality::Local, enbvClearFYes, step, nrnb, wcycle);
     }
 
+    if (overlapHaloExchangeWithCpuCompute && !stepWork.doNeighborSearch)
+    {
+        /* The local non-bonded work is done, now we need the halo coordinates */
+        wallcycle_stop(wcycle, ewcFORCE);
+        dd_move_x_finish(cr->dd, x.unpaddedArrayRef(), wcycle);
+        nbv->convertCoordinates(AtomLocality::NonLocal, false, x.unpaddedArrayRef());
+        wallcycle_start_nocount(wcycle, ewcFORCE);
+    }
+
     if (fr->efep != efepNO && stepWork.computeNonbondedForces)
     {
         /* Calculate the local and non-local free energy interactions here.
@@ -1761,6 +1785,16 @@ void do_force(FILE*                               fplog,
         }
     }
 
+    /* All contributions to the halo forces have been computed,
+     * the remaining CPU work only acts on home atoms.
+     */
+    if (overlapHaloExchangeWithCpuCompute && stepWork.computeForces)
+    {
+        wallcycle_stop(wcycle, ewcFORCE);
+        dd_move_f_start(cr->dd, &forceOutMtsLevel0.forceWithShiftForces(), wcycle);
+        wallcycle_start_nocount(wcycle, ewcFORCE);
+    }
+
     if (stepWork.computeSlowForces)
     {
         calculateLongRangeNonbondeds(fr, inputrec, cr, nrnb, wcycle, mdatoms,
@@ -1905,7 +1939,11 @@ void do_force(FILE*                               fplog,
 
                 // Without MTS or with MTS at slow steps with uncombined forces we need to
                 // communicate the fast forces
-                if (!fr->useMts || !combineMtsForcesBeforeHaloExchange)
+                if (overlapHaloExchangeWithCpuCompute)
+                {
+                    dd_move_f_finish(cr->dd, &forceOutMtsLevel0.forceWithShiftForces(), wcycle);
+                }
+                else if (!fr->useMts || !combineMtsForcesBeforeHaloExchange)
                 {
                     dd_move_f(cr->dd, &forceOutMtsLevel0.forceWithShiftForces(), wcycle);
                 }
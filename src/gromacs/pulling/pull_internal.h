@@ -185,6 +185,11 @@ struct ComSums
     double sum_cmp; /* Sum of cos(xp)*sin(xp)*mass */
     double sum_smp; /* Sum of sin(xp)*sin(xp)*mass */
 
+    /* For cylinder weighting, in addition to sum_wm and sum_wwm */
+    double sum_wma;  /* Sum of weight*mass*axial location               */
+    dvec   sum_mdw;  /* Sum of mass*dweight/dr*radial location          */
+    dvec   sum_mdwa; /* Sum of mass*dweight/dr*radial location*axial location */
+
     /* Dummy data to ensure adjacent elements in an array are separated
      * by a cache line size, max 128 bytes.
      * TODO: Replace this by some automated mechanism.
@@ -61,6 +61,7 @@
 #include "gromacs/math/functions.h"
 #include "gromacs/math/utilities.h"
 #include "gromacs/math/vec.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
 #include "gromacs/mdlib/groupcoord.h"
 #include "gromacs/mdlib/stat.h"
 #include "gromacs/mdrunutility/handlerestart.h"
@@ -140,6 +141,8 @@ struct gmx_enfrotgrp
     const t_rotgrp* rotg = nullptr;
     //! Index of this group within the set of groups
     int groupIndex;
+    //! Number of OpenMP threads for the per-slab work of flexible rotation
+    int nthreads = 1;
     //! Rotation angle in degrees
     real degangle;
     //! Rotation matrix
@@ -733,11 +736,17 @@ static void get_slab_centers(gmx_enfrotgrp* erg,  /* Enforced rotation group wor
                                                      init_rot_group we need to store
                                                      the reference slab centers                   */
 {
-    /* Loop over slabs */
+    /* Loop over slabs, the slabs are independent, so we can use threads */
+#pragma omp parallel for num_threads(erg->nthreads) schedule(static)
     for (int j = erg->slab_first; j <= erg->slab_last; j++)
     {
         int slabIndex                = j - erg->slab_first;
         erg->slab_weights[slabIndex] = get_slab_weight(j, erg, xc, mc, &erg->slab_center[slabIndex]);
+    }
+
+    for (int j = erg->slab_first; j <= erg->slab_last; j++)
+    {
+        int slabIndex = j - erg->slab_first;
 
         /* We can do the calculations ONLY if there is weight in the slab! */
         if (erg->slab_weights[slabIndex] > WEIGHT_MIN)
@@ -1792,25 +1801,27 @@ static int get_single_atom_gaussians(rvec curr_x, gmx_enfrotgrp* erg)
 
 static void flex2_precalc_inner_sum(const gmx_enfrotgrp* erg)
 {
-    rvec xi;       /* positions in the i-sum                        */
-    rvec xcn, ycn; /* the current and the reference slab centers    */
-    real gaussian_xi;
-    rvec yi0;
-    rvec rin; /* Helper variables                              */
-    real fac, fac2;
-    rvec innersumvec;
-    real OOpsii, OOpsiistar;
-    real sin_rin; /* s_ii.r_ii */
-    rvec s_in, tmpvec, tmpvec2;
-    real mi, wi; /* Mass-weighting of the positions                 */
-    real N_M;    /* N/M                                             */
+    real N_M; /* N/M                                             */
 
 
     N_M = erg->rotg->nat * erg->invmass;
 
-    /* Loop over all slabs that contain something */
+    /* Loop over all slabs that contain something, the slabs are independent */
+#pragma omp parallel for num_threads(erg->nthreads) schedule(static)
     for (int n = erg->slab_first; n <= erg->slab_last; n++)
     {
+        rvec xi;       /* positions in the i-sum                        */
+        rvec xcn, ycn; /* the current and the reference slab centers    */
+        real gaussian_xi;
+        rvec yi0;
+        rvec rin; /* Helper variables                              */
+        real fac, fac2;
+        rvec innersumvec;
+        real OOpsii, OOpsiistar;
+        real sin_rin; /* s_ii.r_ii */
+        rvec s_in, tmpvec, tmpvec2;
+        real mi, wi; /* Mass-weighting of the positions                 */
+
         int slabIndex = n - erg->slab_first; /* slab index */
 
         /* The current center of this slab is saved in xcn: */
@@ -1882,21 +1893,23 @@ static void flex2_precalc_inner_sum(const gmx_enfrotgrp* erg)
 
 static void flex_precalc_inner_sum(const gmx_enfrotgrp* erg)
 {
-    rvec xi;       /* position                                      */
-    rvec xcn, ycn; /* the current and the reference slab centers    */
-    rvec qin, rin; /* q_i^n and r_i^n                               */
-    real bin;
-    rvec tmpvec;
-    rvec innersumvec; /* Inner part of sum_n2                          */
-    real gaussian_xi; /* Gaussian weight gn(xi)                        */
-    real mi, wi;      /* Mass-weighting of the positions               */
-    real N_M;         /* N/M                                           */
+    real N_M; /* N/M                                           */
 
     N_M = erg->rotg->nat * erg->invmass;
 
-    /* Loop over all slabs that contain something */
+    /* Loop over all slabs that contain something, the slabs are independent */
+#pragma omp parallel for num_threads(erg->nthreads) schedule(static)
     for (int n = erg->slab_first; n <= erg->slab_last; n++)
     {
+        rvec xi;          /* position                                      */
+        rvec xcn, ycn;    /* the current and the reference slab centers    */
+        rvec qin, rin;    /* q_i^n and r_i^n                               */
+        real bin;
+        rvec tmpvec;
+        rvec innersumvec; /* Inner part of sum_n2                          */
+        real gaussian_xi; /* Gaussian weight gn(xi)                        */
+        real mi, wi;      /* Mass-weighting of the positions               */
+
         int slabIndex = n - erg->slab_first; /* slab index */
 
         /* The current center of this slab is saved in xcn: */
@@ -3688,6 +3701,7 @@ std::unique_ptr<gmx::EnforcedRotation> init_rot(FILE*                       fplo
         erg->atomSet       = std::make_unique<gmx::LocalAtomSet>(
                 atomSets->add({ erg->rotg->ind, erg->rotg->ind + erg->rotg->nat }));
         erg->groupIndex = groupIndex;
+        erg->nthreads   = std::max(1, gmx_omp_nthreads_get(emntDefault));
 
         if (nullptr != fplog)
         {
@@ -178,6 +178,91 @@ static void pull_set_pbcatoms(const t_commrec* cr, struct pull_t* pull, const rv
     }
 }
 
+/* Computes the cylinder weights and their derivatives for local atoms
+ * ind_start to ind_end of the reference group pref of a cylinder pull coordinate.
+ * The weights and derivatives are stored in pdyna, the sums in sums.
+ */
+static void sum_cyl_part(const pull_group_work_t& pref,
+                         pull_group_work_t*       pdyna,
+                         int                      ind_start,
+                         int                      ind_end,
+                         const real*              masses,
+                         const t_pbc*             pbc,
+                         const rvec*              x,
+                         const rvec               reference,
+                         const rvec               direction,
+                         double                   inv_cyl_r2,
+                         ComSums*                 sums)
+{
+    double sum_a     = 0;
+    double wmass     = 0;
+    double wwmass    = 0;
+    dvec   radf_fac0 = { 0, 0, 0 };
+    dvec   radf_fac1 = { 0, 0, 0 };
+
+    auto localAtomIndices = pref.atomSet.localIndex();
+
+    /* loop over the atoms in the main ref group */
+    for (int indexInSet = ind_start; indexInSet < ind_end; indexInSet++)
+    {
+        int  atomIndex = localAtomIndices[indexInSet];
+        rvec dx;
+        pbc_dx_aiuc(pbc, x[atomIndex], reference, dx);
+        double axialLocation = iprod(direction, dx);
+        dvec   radialLocation;
+        double dr2 = 0;
+        for (int m = 0; m < DIM; m++)
+        {
+            /* Determine the radial components */
+            radialLocation[m] = dx[m] - axialLocation * direction[m];
+            dr2 += gmx::square(radialLocation[m]);
+        }
+        double dr2_rel = dr2 * inv_cyl_r2;
+
+        if (dr2_rel < 1)
+        {
+            /* add atom to sum of COM and to weight array */
+
+            double mass = masses[atomIndex];
+            /* The radial weight function is 1-2x^2+x^4,
+             * where x=r/cylinder_r. Since this function depends
+             * on the radial component, we also get radial forces
+             * on both groups.
+             */
+            double weight                   = 1 + (-2 + dr2_rel) * dr2_rel;
+            double dweight_r                = (-4 + 4 * dr2_rel) * inv_cyl_r2;
+            pdyna->localWeights[indexInSet] = weight;
+            sum_a += mass * weight * axialLocation;
+            wmass += mass * weight;
+            wwmass += mass * weight * weight;
+            dvec mdw;
+            dsvmul(mass * dweight_r, radialLocation, mdw);
+            copy_dvec(mdw, pdyna->mdw[indexInSet]);
+            /* Currently we only have the axial component of the
+             * offset from the cylinder COM up to an unkown offset.
+             * We add this offset after the reduction needed
+             * for determining the COM of the cylinder group.
+             */
+            pdyna->dv[indexInSet] = axialLocation;
+            for (int m = 0; m < DIM; m++)
+            {
+                radf_fac0[m] += mdw[m];
+                radf_fac1[m] += mdw[m] * axialLocation;
+            }
+        }
+        else
+        {
+            pdyna->localWeights[indexInSet] = 0;
+        }
+    }
+
+    sums->sum_wm  = wmass;
+    sums->sum_wwm = wwmass;
+    sums->sum_wma = sum_a;
+    copy_dvec(radf_fac0, sums->sum_mdw);
+    copy_dvec(radf_fac1, sums->sum_mdwa);
+}
+
 static void
 make_cyl_refgrps(const t_commrec* cr, pull_t* pull, const real* masses, t_pbc* pbc, double t, const rvec* x)
 {
@@ -238,59 +323,41 @@ make_cyl_refgrps(const t_commrec* cr, pull_t* pull, const real* masses, t_pbc* p
             pdyna.mdw.resize(localAtomIndices.size());
             pdyna.dv.resize(localAtomIndices.size());
 
-            /* loop over all atoms in the main ref group */
-            for (gmx::index indexInSet = 0; indexInSet < localAtomIndices.ssize(); indexInSet++)
+            /* The final sums should end up in comSums[0] */
+            ComSums& cylSumsTotal = pull->comSums[0];
+
+            if (pref.atomSet.numAtomsLocal() <= c_pullMaxNumLocalAtomsSingleThreaded)
             {
-                int  atomIndex = localAtomIndices[indexInSet];
-                rvec dx;
-                pbc_dx_aiuc(pbc, x[atomIndex], reference, dx);
-                double axialLocation = iprod(direction, dx);
-                dvec   radialLocation;
-                double dr2 = 0;
-                for (int m = 0; m < DIM; m++)
+                sum_cyl_part(pref, &pdyna, 0, pref.atomSet.numAtomsLocal(), masses, pbc, x, reference,
+                             direction, inv_cyl_r2, &cylSumsTotal);
+            }
+            else
+            {
+#pragma omp parallel for num_threads(pull->nthreads) schedule(static)
+                for (int t = 0; t < pull->nthreads; t++)
                 {
-                    /* Determine the radial components */
-                    radialLocation[m] = dx[m] - axialLocation * direction[m];
-                    dr2 += gmx::square(radialLocation[m]);
+                    int ind_start = (pref.atomSet.numAtomsLocal() * (t + 0)) / pull->nthreads;
+                    int ind_end   = (pref.atomSet.numAtomsLocal() * (t + 1)) / pull->nthreads;
+                    sum_cyl_part(pref, &pdyna, ind_start, ind_end, masses, pbc, x, reference,
+                                 direction, inv_cyl_r2, &pull->comSums[t]);
                 }
-                double dr2_rel = dr2 * inv_cyl_r2;
 
-                if (dr2_rel < 1)
-                {
-                    /* add atom to sum of COM and to weight array */
-
-                    double mass = masses[atomIndex];
-                    /* The radial weight function is 1-2x^2+x^4,
-                     * where x=r/cylinder_r. Since this function depends
-                     * on the radial component, we also get radial forces
-                     * on both groups.
-                     */
-                    double weight                  = 1 + (-2 + dr2_rel) * dr2_rel;
-                    double dweight_r               = (-4 + 4 * dr2_rel) * inv_cyl_r2;
-                    pdyna.localWeights[indexInSet] = weight;
-                    sum_a += mass * weight * axialLocation;
-                    wmass += mass * weight;
-                    wwmass += mass * weight * weight;
-                    dvec mdw;
-                    dsvmul(mass * dweight_r, radialLocation, mdw);
-                    copy_dvec(mdw, pdyna.mdw[indexInSet]);
-                    /* Currently we only have the axial component of the
-                     * offset from the cylinder COM up to an unkown offset.
-                     * We add this offset after the reduction needed
-                     * for determining the COM of the cylinder group.
-                     */
-                    pdyna.dv[indexInSet] = axialLocation;
-                    for (int m = 0; m < DIM; m++)
-                    {
-                        radf_fac0[m] += mdw[m];
-                        radf_fac1[m] += mdw[m] * axialLocation;
-                    }
-                }
-                else
+                /* Reduce the thread contributions to comSums[0] */
+                for (int t = 1; t < pull->nthreads; t++)
                 {
-                    pdyna.localWeights[indexInSet] = 0;
+                    cylSumsTotal.sum_wm += pull->comSums[t].sum_wm;
+                    cylSumsTotal.sum_wwm += pull->comSums[t].sum_wwm;
+                    cylSumsTotal.sum_wma += pull->comSums[t].sum_wma;
+                    dvec_inc(cylSumsTotal.sum_mdw, pull->comSums[t].sum_mdw);
+                    dvec_inc(cylSumsTotal.sum_mdwa, pull->comSums[t].sum_mdwa);
                 }
             }
+
+            sum_a  = cylSumsTotal.sum_wma;
+            wmass  = cylSumsTotal.sum_wm;
+            wwmass = cylSumsTotal.sum_wwm;
+            copy_dvec(cylSumsTotal.sum_mdw, radf_fac0);
+            copy_dvec(cylSumsTotal.sum_mdwa, radf_fac1);
         }
 
         auto buffer = gmx::arrayRefFromArray(
@@ -46,12 +46,31 @@
 
 #include <cmath>
 
+#include <algorithm>
+
 #include "gromacs/math/vec.h"
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/topology/block.h"
 #include "gromacs/topology/mtop_lookup.h"
 #include "gromacs/topology/topology.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
+
+/*! \brief
+ * Minimum number of blocks per thread in the block center calculations.
+ *
+ * Blocks are typically residues or molecules with only a few atoms, so
+ * many blocks are needed to amortize the cost of starting the threads.
+ */
+static const int c_centerMinBlocksPerThread = 1000;
+
+/*! \brief
+ * Returns the number of threads to use for computing \p numBlocks centers.
+ */
+static int center_block_num_threads(int numBlocks)
+{
+    return std::max(1, std::min(gmx_omp_get_max_threads(), numBlocks / c_centerMinBlocksPerThread));
+}
 
 void gmx_calc_cog(const gmx_mtop_t* /* top */, rvec x[], int nrefat, const int index[], rvec xout)
 {
@@ -325,15 +344,15 @@ void gmx_calc_comg_pbc(const gmx_mtop_t* top, rvec x[], const t_pbc* pbc, int nr
 
 void gmx_calc_cog_block(const gmx_mtop_t* /* top */, rvec x[], const t_block* block, const int index[], rvec xout[])
 {
-    int  b, i, ai;
-    rvec xb;
-
-    for (b = 0; b < block->nr; ++b)
+    const int numThreads = center_block_num_threads(block->nr);
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int b = 0; b < block->nr; ++b)
     {
+        rvec xb;
         clear_rvec(xb);
-        for (i = block->index[b]; i < block->index[b + 1]; ++i)
+        for (int i = block->index[b]; i < block->index[b + 1]; ++i)
         {
-            ai = index[i];
+            const int ai = index[i];
             rvec_inc(xb, x[ai]);
         }
         svmul(1.0 / (block->index[b + 1] - block->index[b]), xb, xout[b]);
@@ -354,7 +373,9 @@ void gmx_calc_com_block(const gmx_mtop_t* top, rvec x[], const t_block* block, c
 {
     GMX_RELEASE_ASSERT(gmx_mtop_has_masses(top),
                        "No masses available while mass weighting was requested");
-    int molb = 0;
+    const int numThreads = center_block_num_threads(block->nr);
+    int       molb       = 0;
+#pragma omp parallel for num_threads(numThreads) schedule(static) firstprivate(molb)
     for (int b = 0; b < block->nr; ++b)
     {
         rvec xb;
@@ -385,7 +406,9 @@ void gmx_calc_cog_f_block(const gmx_mtop_t* top, rvec f[], const t_block* block,
 {
     GMX_RELEASE_ASSERT(gmx_mtop_has_masses(top),
                        "No masses available while mass weighting was requested");
-    int molb = 0;
+    const int numThreads = center_block_num_threads(block->nr);
+    int       molb       = 0;
+#pragma omp parallel for num_threads(numThreads) schedule(static) firstprivate(molb)
     for (int b = 0; b < block->nr; ++b)
     {
         rvec fb;
@@ -411,6 +434,8 @@ void gmx_calc_com_f_block(const gmx_mtop_t* /* top */,
                           const int      index[],
                           rvec           fout[])
 {
+    const int numThreads = center_block_num_threads(block->nr);
+#pragma omp parallel for num_threads(numThreads) schedule(static)
     for (int b = 0; b < block->nr; ++b)
     {
         rvec fb;
@@ -66,6 +66,7 @@
 #include "gromacs/selection/selection.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
 #include "mempool.h"
@@ -451,12 +452,24 @@ void SelectionEvaluator::evaluate(SelectionCollection* coll, t_trxframe* fr, t_p
         }
         sel = sel->next;
     }
-    /* Update selection information */
+    /* Update selection information.
+     * The masses and charges of different selections are independent, so
+     * they are computed in parallel. */
+    const int numSelections = gmx::ssize(sc->sel);
+    const int numThreads    = std::max(1, std::min(gmx_omp_get_max_threads(), numSelections));
+#pragma omp parallel for num_threads(numThreads) schedule(dynamic)
+    for (int i = 0; i < numSelections; ++i)
+    {
+        try
+        {
+            sc->sel[i]->refreshMassesAndCharges(sc->top);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
     SelectionDataList::const_iterator isel;
     for (isel = sc->sel.begin(); isel != sc->sel.end(); ++isel)
     {
         internal::SelectionData& sel = **isel;
-        sel.refreshMassesAndCharges(sc->top);
         sel.updateCoveredFractionForFrame();
     }
 }
@@ -1126,12 +1139,16 @@ void _gmx_sel_evaluate_or(gmx_sel_evaluate_t*                     data,
             child->evaluate(data, child, &tmp);
             gmx_ana_index_partition(&tmp, &tmp2, &tmp, child->v.u.g);
         }
+        /* The new atoms are a sorted block after the previous ones, and the
+         * remaining atoms are after them, so a merge keeps the value sorted
+         * without touching the remaining atoms. */
+        int* index = sel->v.u.g->index;
+        std::inplace_merge(index, index + sel->v.u.g->isize, index + sel->v.u.g->isize + tmp.isize);
         sel->v.u.g->isize += tmp.isize;
         tmp.isize = tmp2.isize;
         tmp.index = tmp2.index;
         child     = child->next;
     }
-    gmx_ana_index_sort(sel->v.u.g);
 }
 
 
@@ -348,6 +348,11 @@ public:
 
     //! Initializes a search to find reference positions neighboring \p x.
     void startSearch(const AnalysisNeighborhoodPositions& positions);
+    /*! \brief
+     * Initializes a search to find reference positions neighboring test
+     * positions [\p testBegin, \p testEnd) in \p positions.
+     */
+    void startSearch(const AnalysisNeighborhoodPositions& positions, int testBegin, int testEnd);
     //! Initializes a search to find reference position pairs.
     void startSelfSearch();
     //! Searches for the next neighbor.
@@ -357,6 +362,8 @@ public:
     void initFoundPair(AnalysisNeighborhoodPair* pair) const;
     //! Advances to the next test position, skipping any remaining pairs.
     void nextTestPosition();
+    //! Returns the index of the currently active test position.
+    int testIndex() const { return testIndex_; }
 
 private:
     //! Clears the loop indices.
@@ -1029,26 +1036,34 @@ bool AnalysisNeighborhoodPairSearchImpl::isExcluded(int j)
 
 void AnalysisNeighborhoodPairSearchImpl::startSearch(const AnalysisNeighborhoodPositions& positions)
 {
-    selfSearchMode_   = false;
-    testPosCount_     = positions.count_;
-    testPositions_    = positions.x_;
-    testExclusionIds_ = positions.exclusionIds_;
-    testIndices_      = positions.indices_;
-    GMX_RELEASE_ASSERT(search_.excls_ == nullptr || testExclusionIds_ != nullptr,
-                       "Exclusion IDs must be set when exclusions are enabled");
     if (positions.index_ < 0)
     {
-        reset(0);
+        startSearch(positions, 0, positions.count_);
     }
     else
     {
         // Somewhat of a hack: setup the array such that only the last position
         // will be used.
-        testPosCount_ = positions.index_ + 1;
-        reset(positions.index_);
+        startSearch(positions, positions.index_, positions.index_ + 1);
     }
 }
 
+void AnalysisNeighborhoodPairSearchImpl::startSearch(const AnalysisNeighborhoodPositions& positions,
+                                                     int testBegin,
+                                                     int testEnd)
+{
+    GMX_RELEASE_ASSERT(testBegin >= 0 && testBegin <= testEnd && testEnd <= positions.count_,
+                       "Invalid range of test positions");
+    selfSearchMode_   = false;
+    testPosCount_     = testEnd;
+    testPositions_    = positions.x_;
+    testExclusionIds_ = positions.exclusionIds_;
+    testIndices_      = positions.indices_;
+    GMX_RELEASE_ASSERT(search_.excls_ == nullptr || testExclusionIds_ != nullptr,
+                       "Exclusion IDs must be set when exclusions are enabled");
+    reset(testBegin);
+}
+
 void AnalysisNeighborhoodPairSearchImpl::startSelfSearch()
 {
     selfSearchMode_   = true;
@@ -1230,6 +1245,49 @@ private:
     GMX_DISALLOW_ASSIGN(MindistAction);
 };
 
+/*! \brief
+ * Search action to collect all neighbors.
+ *
+ * Used as the action for AnalysisNeighborhoodPairSearchImpl::searchNext() to
+ * store all pairs within the cutoff.
+ *
+ * With this action, AnalysisNeighborhoodPairSearchImpl::searchNext() always
+ * returns false, and the pairs are appended to the vector passed into the
+ * constructor.
+ */
+class CollectPairsAction
+{
+public:
+    /*! \brief
+     * Initializes the action with given search and output location.
+     *
+     * \param[in]  search Search that calls this action, used to get the
+     *     current test position.
+     * \param[out] pairs  Vector to append the found pairs to.
+     */
+    CollectPairsAction(const internal::AnalysisNeighborhoodPairSearchImpl& search,
+                       std::vector<AnalysisNeighborhoodPair>*              pairs) :
+        search_(search),
+        pairs_(*pairs)
+    {
+    }
+    //! Copies the action.
+    CollectPairsAction(const CollectPairsAction&) = default;
+
+    //! Stores a found neighbor.
+    bool operator()(int i, real r2, const rvec dx)
+    {
+        pairs_.emplace_back(i, search_.testIndex(), r2, dx);
+        return false;
+    }
+
+private:
+    const internal::AnalysisNeighborhoodPairSearchImpl& search_;
+    std::vector<AnalysisNeighborhoodPair>&              pairs_;
+
+    GMX_DISALLOW_ASSIGN(CollectPairsAction);
+};
+
 } // namespace
 
 /********************************************************************
@@ -1396,6 +1454,38 @@ AnalysisNeighborhoodSearch::startPairSearch(const AnalysisNeighborhoodPositions&
     return AnalysisNeighborhoodPairSearch(pairSearch);
 }
 
+void AnalysisNeighborhoodSearch::findAllPairs(const AnalysisNeighborhoodPositions& positions,
+                                              int                                  testBegin,
+                                              int                                  testEnd,
+                                              int                                  numThreads,
+                                              std::vector<AnalysisNeighborhoodPair>* pairs) const
+{
+    GMX_RELEASE_ASSERT(impl_, "Accessing an invalid search object");
+    pairs->clear();
+    // Each thread handles a contiguous block of test positions, and the
+    // pairs are concatenated in thread order to keep the serial pair order.
+    const int numTestPositions = testEnd - testBegin;
+    numThreads                 = std::max(1, std::min(numThreads, numTestPositions));
+    std::vector<std::vector<AnalysisNeighborhoodPair>> threadPairs(numThreads - 1);
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int thread = 0; thread < numThreads; ++thread)
+    {
+        try
+        {
+            internal::AnalysisNeighborhoodPairSearchImpl pairSearch(*impl_);
+            pairSearch.startSearch(positions, testBegin + (thread * numTestPositions) / numThreads,
+                                   testBegin + ((thread + 1) * numTestPositions) / numThreads);
+            CollectPairsAction action(pairSearch, thread == 0 ? pairs : &threadPairs[thread - 1]);
+            (void)pairSearch.searchNext(action);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+    for (const auto& threadPairList : threadPairs)
+    {
+        pairs->insert(pairs->end(), threadPairList.begin(), threadPairList.end());
+    }
+}
+
 /********************************************************************
  * AnalysisNeighborhoodPairSearch
  */
@@ -534,6 +534,30 @@ public:
      */
     AnalysisNeighborhoodPairSearch startPairSearch(const AnalysisNeighborhoodPositions& positions) const;
 
+    /*! \brief
+     * Finds all reference positions within a cutoff for a range of test positions.
+     *
+     * \param[in]  positions  Set of test positions to use.
+     * \param[in]  testBegin  Index of the first test position to search for.
+     * \param[in]  testEnd    One past the index of the last test position.
+     * \param[in]  numThreads Number of OpenMP threads to divide the test
+     *     positions over.
+     * \param[out] pairs      All found pairs.
+     * \throws    std::bad_alloc if out of memory.
+     *
+     * The pairs are returned in the same order as a search started with
+     * startPairSearch() returns them from
+     * AnalysisNeighborhoodPairSearch::findNextPair(), limited to test
+     * positions in [\p testBegin, \p testEnd).  The order does not depend
+     * on \p numThreads.  Calling this method repeatedly with consecutive
+     * ranges of test positions limits the memory needed for \p pairs.
+     */
+    void findAllPairs(const AnalysisNeighborhoodPositions& positions,
+                      int                                  testBegin,
+                      int                                  testEnd,
+                      int                                  numThreads,
+                      std::vector<AnalysisNeighborhoodPair>* pairs) const;
+
 private:
     typedef internal::AnalysisNeighborhoodSearchImpl Impl;
 
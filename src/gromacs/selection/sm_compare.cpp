@@ -498,96 +498,112 @@ static void free_data_compare(void* data)
 }
 
 /*! \brief
- * Implementation for evaluate_compare() for integer values.
- *
- * \param[in]  g     Evaluation index group.
- * \param[out] out   Output data structure (\p out->u.g is used).
- * \param[in]  data  Should point to a \c t_methoddata_compare.
+ * Returns whether two integer values are equal.
  */
-static void evaluate_compare_int(gmx_ana_index_t* g, gmx_ana_selvalue_t* out, void* data)
+static inline bool compare_values_equal(int a, int b)
 {
-    t_methoddata_compare* d = static_cast<t_methoddata_compare*>(data);
-    int                   i, i1, i2, ig;
-    int                   a, b;
-    bool                  bAccept;
+    return a == b;
+}
 
-    for (i = i1 = i2 = ig = 0; i < g->isize; ++i)
+/*! \brief
+ * Returns whether two real values are equal within rounding tolerance.
+ */
+static inline bool compare_values_equal(real a, real b)
+{
+    return gmx_within_tol(a, b, GMX_REAL_EPS);
+}
+
+/*! \brief
+ * Selects the atoms for which a comparison is true.
+ *
+ * \tparam     LeftType    Type of the left values.
+ * \tparam     RightType   Type of the right values.
+ * \tparam     Accept      Function object type for the comparison.
+ * \param[in]  g           Evaluation index group.
+ * \param[in]  left        Left values.
+ * \param[in]  leftStride  1 if \p left has a value for each atom in \p g,
+ *     0 if it has a single value.
+ * \param[in]  right       Right values.
+ * \param[in]  rightStride As \p leftStride, for \p right.
+ * \param[in]  accept      Comparison, called with both values as \p LeftType.
+ * \param[out] out         Output group.
+ *
+ * The index is stored for every atom and only kept if the comparison is
+ * true, so that the loop does not branch on the result of the comparison.
+ * \p out can share the index array with \p g.
+ */
+template<typename LeftType, typename RightType, class Accept>
+static void select_accepted(const gmx_ana_index_t& g,
+                            const LeftType*        left,
+                            int                    leftStride,
+                            const RightType*       right,
+                            int                    rightStride,
+                            Accept                 accept,
+                            gmx_ana_index_t*       out)
+{
+    int* outIndex = out->index;
+    int  outCount = 0;
+    for (int i = 0; i < g.isize; ++i)
     {
-        a       = d->left.i[i1];
-        b       = d->right.i[i2];
-        bAccept = false;
-        switch (d->cmpt)
-        {
-            case CMP_INVALID: break;
-            case CMP_LESS: bAccept = a < b; break;
-            case CMP_LEQ: bAccept = a <= b; break;
-            case CMP_GTR: bAccept = a > b; break;
-            case CMP_GEQ: bAccept = a >= b; break;
-            case CMP_EQUAL: bAccept = a == b; break;
-            case CMP_NEQ: bAccept = a != b; break;
-        }
-        if (bAccept)
-        {
-            out->u.g->index[ig++] = g->index[i];
-        }
-        if (!(d->left.flags & CMP_SINGLEVAL))
-        {
-            ++i1;
-        }
-        if (!(d->right.flags & CMP_SINGLEVAL))
-        {
-            ++i2;
-        }
+        const bool bAccept =
+                accept(left[i * leftStride], static_cast<LeftType>(right[i * rightStride]));
+        outIndex[outCount] = g.index[i];
+        outCount += static_cast<int>(bAccept);
     }
-    out->u.g->isize = ig;
+    out->isize = outCount;
 }
 
 /*! \brief
- * Implementation for evaluate_compare() if either value is non-integer.
+ * Implementation for evaluate_compare() for given value types.
  *
  * \param[in]  g     Evaluation index group.
  * \param[out] out   Output data structure (\p out->u.g is used).
- * \param[in]  data  Should point to a \c t_methoddata_compare.
+ * \param[in]  d     Comparison data.
+ * \param[in]  left  Left values.
+ * \param[in]  right Right values.
  *
- * Left value is assumed to be real-valued; right value can be either.
- * This is ensured by the initialization method.
+ * Selects a loop specialized for the comparison operator, such that the
+ * operator and the operand types do not need to be checked for each atom.
  */
-static void evaluate_compare_real(gmx_ana_index_t* g, gmx_ana_selvalue_t* out, void* data)
+template<typename LeftType, typename RightType>
+static void evaluate_compare_values(gmx_ana_index_t*            g,
+                                    gmx_ana_selvalue_t*         out,
+                                    const t_methoddata_compare& d,
+                                    const LeftType*             left,
+                                    const RightType*            right)
 {
-    t_methoddata_compare* d = static_cast<t_methoddata_compare*>(data);
-    int                   i, i1, i2, ig;
-    real                  a, b;
-    bool                  bAccept;
-
-    for (i = i1 = i2 = ig = 0; i < g->isize; ++i)
+    const int leftStride  = (d.left.flags & CMP_SINGLEVAL) ? 0 : 1;
+    const int rightStride = (d.right.flags & CMP_SINGLEVAL) ? 0 : 1;
+    switch (d.cmpt)
     {
-        a       = d->left.r[i1];
-        b       = (d->right.flags & CMP_REALVAL) ? d->right.r[i2] : d->right.i[i2];
-        bAccept = false;
-        switch (d->cmpt)
-        {
-            case CMP_INVALID: break;
-            case CMP_LESS: bAccept = a < b; break;
-            case CMP_LEQ: bAccept = a <= b; break;
-            case CMP_GTR: bAccept = a > b; break;
-            case CMP_GEQ: bAccept = a >= b; break;
-            case CMP_EQUAL: bAccept = gmx_within_tol(a, b, GMX_REAL_EPS); break;
-            case CMP_NEQ: bAccept = !gmx_within_tol(a, b, GMX_REAL_EPS); break;
-        }
-        if (bAccept)
-        {
-            out->u.g->index[ig++] = g->index[i];
-        }
-        if (!(d->left.flags & CMP_SINGLEVAL))
-        {
-            ++i1;
-        }
-        if (!(d->right.flags & CMP_SINGLEVAL))
-        {
-            ++i2;
-        }
+        case CMP_INVALID: out->u.g->isize = 0; break;
+        case CMP_LESS:
+            select_accepted(*g, left, leftStride, right, rightStride,
+                            [](LeftType a, LeftType b) { return a < b; }, out->u.g);
+            break;
+        case CMP_LEQ:
+            select_accepted(*g, left, leftStride, right, rightStride,
+                            [](LeftType a, LeftType b) { return a <= b; }, out->u.g);
+            break;
+        case CMP_GTR:
+            select_accepted(*g, left, leftStride, right, rightStride,
+                            [](LeftType a, LeftType b) { return a > b; }, out->u.g);
+            break;
+        case CMP_GEQ:
+            select_accepted(*g, left, leftStride, right, rightStride,
+                            [](LeftType a, LeftType b) { return a >= b; }, out->u.g);
+            break;
+        case CMP_EQUAL:
+            select_accepted(*g, left, leftStride, right, rightStride,
+                            [](LeftType a, LeftType b) { return compare_values_equal(a, b); },
+                            out->u.g);
+            break;
+        case CMP_NEQ:
+            select_accepted(*g, left, leftStride, right, rightStride,
+                            [](LeftType a, LeftType b) { return !compare_values_equal(a, b); },
+                            out->u.g);
+            break;
     }
-    out->u.g->isize = ig;
 }
 
 static void evaluate_compare(const gmx::SelMethodEvalContext& /*context*/,
@@ -597,12 +613,18 @@ static void evaluate_compare(const gmx::SelMethodEvalContext& /*context*/,
 {
     t_methoddata_compare* d = static_cast<t_methoddata_compare*>(data);
 
+    /* The initialization method ensures that the left value is real if
+     * either value is real. */
     if (!((d->left.flags | d->right.flags) & CMP_REALVAL))
     {
-        evaluate_compare_int(g, out, data);
+        evaluate_compare_values(g, out, *d, d->left.i, d->right.i);
+    }
+    else if (d->right.flags & CMP_REALVAL)
+    {
+        evaluate_compare_values(g, out, *d, d->left.r, d->right.r);
     }
     else
     {
-        evaluate_compare_real(g, out, data);
+        evaluate_compare_values(g, out, *d, d->left.r, d->right.i);
     }
 }
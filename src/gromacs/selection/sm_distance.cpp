@@ -46,10 +46,14 @@
  */
 #include "gmxpre.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "gromacs/math/vec.h"
 #include "gromacs/selection/nbsearch.h"
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxomp.h"
 
 #include "position.h"
 #include "selmethod.h"
@@ -75,8 +79,27 @@ struct t_methoddata_distance
     gmx::AnalysisNeighborhood nb;
     /** Neighborhood search for an invididual frame. */
     gmx::AnalysisNeighborhoodSearch nbsearch;
+    /** Whether each evaluated position is within the cutoff (for \p within). */
+    std::vector<char> bWithin;
 };
 
+/*! \brief
+ * Minimum number of evaluated positions per thread.
+ *
+ * Each position is searched for independently, so the evaluation can be
+ * split over threads, but a single search is cheap compared to starting
+ * threads.
+ */
+static const int c_distanceMinPositionsPerThread = 1000;
+
+/*! \brief
+ * Returns the number of threads to use for searching \p count positions.
+ */
+static int distance_num_threads(int count)
+{
+    return std::max(1, std::min(gmx_omp_get_max_threads(), count / c_distanceMinPositionsPerThread));
+}
+
 /*! \brief
  * Allocates data for distance-based selection methods.
  *
@@ -280,10 +303,16 @@ static void evaluate_distance(const gmx::SelMethodEvalContext& /*context*/,
 {
     t_methoddata_distance* d = static_cast<t_methoddata_distance*>(data);
 
-    out->nr = pos->count();
+    out->nr              = pos->count();
+    const int numThreads = distance_num_threads(pos->count());
+#pragma omp parallel for num_threads(numThreads) schedule(static)
     for (int i = 0; i < pos->count(); ++i)
     {
-        out->u.r[i] = d->nbsearch.minimumDistance(pos->x[i]);
+        try
+        {
+            out->u.r[i] = d->nbsearch.minimumDistance(pos->x[i]);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
     }
 }
 
@@ -293,6 +322,8 @@ static void evaluate_distance(const gmx::SelMethodEvalContext& /*context*/,
  *
  * Finds the atoms that are closer than the defined cutoff to
  * \c t_methoddata_distance::xref and puts them in \p out.g.
+ * The positions are searched in parallel, and the atoms are added to the
+ * output in the order of the positions afterwards.
  */
 static void evaluate_within(const gmx::SelMethodEvalContext& /*context*/,
                             gmx_ana_pos_t*      pos,
@@ -301,10 +332,21 @@ static void evaluate_within(const gmx::SelMethodEvalContext& /*context*/,
 {
     t_methoddata_distance* d = static_cast<t_methoddata_distance*>(data);
 
+    d->bWithin.resize(pos->count());
+    const int numThreads = distance_num_threads(pos->count());
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int b = 0; b < pos->count(); ++b)
+    {
+        try
+        {
+            d->bWithin[b] = static_cast<char>(d->nbsearch.isWithin(pos->x[b]));
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
     out->u.g->isize = 0;
     for (int b = 0; b < pos->count(); ++b)
     {
-        if (d->nbsearch.isWithin(pos->x[b]))
+        if (d->bWithin[b])
         {
             gmx_ana_pos_add_to_group(out->u.g, pos, b);
         }
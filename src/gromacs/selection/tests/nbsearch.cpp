@@ -407,6 +407,9 @@ public:
                                    const gmx::ArrayRef<const int>&           refIndices,
                                    const gmx::ArrayRef<const int>&           testIndices,
                                    bool                                      selfPairs);
+    static void testFindAllPairs(gmx::AnalysisNeighborhoodSearch*          search,
+                                 const gmx::AnalysisNeighborhoodPositions& pos,
+                                 int                                       testPosCount);
 
     gmx::AnalysisNeighborhood nb_;
 };
@@ -642,6 +645,42 @@ void NeighborhoodSearchTest::testPairSearchFull(gmx::AnalysisNeighborhoodSearch*
     }
 }
 
+void NeighborhoodSearchTest::testFindAllPairs(gmx::AnalysisNeighborhoodSearch*          search,
+                                              const gmx::AnalysisNeighborhoodPositions& pos,
+                                              int testPosCount)
+{
+    std::vector<gmx::AnalysisNeighborhoodPair> expectedPairs;
+    gmx::AnalysisNeighborhoodPairSearch        pairSearch = search->startPairSearch(pos);
+    gmx::AnalysisNeighborhoodPair              pair;
+    while (pairSearch.findNextPair(&pair))
+    {
+        expectedPairs.push_back(pair);
+    }
+    ASSERT_FALSE(expectedPairs.empty());
+
+    const int                                  testBegin = testPosCount / 3;
+    std::vector<gmx::AnalysisNeighborhoodPair> pairs;
+    for (int numThreads : { 1, 2, 7 })
+    {
+        SCOPED_TRACE(gmx::formatString("Using %d threads", numThreads));
+        // Search in two consecutive blocks of test positions
+        search->findAllPairs(pos, 0, testBegin, numThreads, &pairs);
+        std::vector<gmx::AnalysisNeighborhoodPair> allPairs(pairs);
+        search->findAllPairs(pos, testBegin, testPosCount, numThreads, &pairs);
+        allPairs.insert(allPairs.end(), pairs.begin(), pairs.end());
+        ASSERT_EQ(expectedPairs.size(), allPairs.size());
+        for (size_t i = 0; i < allPairs.size(); ++i)
+        {
+            EXPECT_EQ(expectedPairs[i].refIndex(), allPairs[i].refIndex());
+            EXPECT_EQ(expectedPairs[i].testIndex(), allPairs[i].testIndex());
+            EXPECT_EQ(expectedPairs[i].distance2(), allPairs[i].distance2());
+            EXPECT_EQ(expectedPairs[i].dx()[XX], allPairs[i].dx()[XX]);
+            EXPECT_EQ(expectedPairs[i].dx()[YY], allPairs[i].dx()[YY]);
+            EXPECT_EQ(expectedPairs[i].dx()[ZZ], allPairs[i].dx()[ZZ]);
+        }
+    }
+}
+
 /********************************************************************
  * Test data generation
  */
@@ -1133,4 +1172,46 @@ TEST_F(NeighborhoodSearchTest, GridSearchExclusions)
                        helper.exclusions(), {}, {}, false);
 }
 
+TEST_F(NeighborhoodSearchTest, SimpleSearchFindsAllPairs)
+{
+    const NeighborhoodSearchTestData& data = RandomBoxFullPBCData::get();
+
+    nb_.setCutoff(data.cutoff_);
+    nb_.setMode(gmx::AnalysisNeighborhood::eSearchMode_Simple);
+    gmx::AnalysisNeighborhoodSearch search = nb_.initSearch(&data.pbc_, data.refPositions());
+    ASSERT_EQ(gmx::AnalysisNeighborhood::eSearchMode_Simple, search.mode());
+
+    testFindAllPairs(&search, data.testPositions(), data.testPositions_.size());
+}
+
+TEST_F(NeighborhoodSearchTest, GridSearchFindsAllPairs)
+{
+    const NeighborhoodSearchTestData& data = RandomTriclinicFullPBCData::get();
+
+    nb_.setCutoff(data.cutoff_);
+    nb_.setMode(gmx::AnalysisNeighborhood::eSearchMode_Grid);
+    gmx::AnalysisNeighborhoodSearch search = nb_.initSearch(&data.pbc_, data.refPositions());
+    ASSERT_EQ(gmx::AnalysisNeighborhood::eSearchMode_Grid, search.mode());
+
+    testFindAllPairs(&search, data.testPositions(), data.testPositions_.size());
+}
+
+TEST_F(NeighborhoodSearchTest, GridSearchFindsAllPairsWithExclusions)
+{
+    const NeighborhoodSearchTestData& data = RandomBoxFullPBCData::get();
+
+    ExclusionsHelper helper(data.refPosCount_, data.testPositions_.size());
+    helper.generateExclusions();
+
+    nb_.setCutoff(data.cutoff_);
+    nb_.setTopologyExclusions(helper.exclusions());
+    nb_.setMode(gmx::AnalysisNeighborhood::eSearchMode_Grid);
+    gmx::AnalysisNeighborhoodSearch search =
+            nb_.initSearch(&data.pbc_, data.refPositions().exclusionIds(helper.refPosIds()));
+    ASSERT_EQ(gmx::AnalysisNeighborhood::eSearchMode_Grid, search.mode());
+
+    testFindAllPairs(&search, data.testPositions().exclusionIds(helper.testPosIds()),
+                     data.testPositions_.size());
+}
+
 } // namespace
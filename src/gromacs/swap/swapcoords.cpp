@@ -48,6 +48,8 @@
 #include <cstdlib>
 #include <ctime>
 
+#include <algorithm>
+#include <array>
 #include <memory>
 #include <string>
 #include <vector>
@@ -60,6 +62,7 @@
 #include "gromacs/fileio/xvgr.h"
 #include "gromacs/gmxlib/network.h"
 #include "gromacs/math/vec.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
 #include "gromacs/mdlib/groupcoord.h"
 #include "gromacs/mdrunutility/handlerestart.h"
 #include "gromacs/mdtypes/commrec.h"
@@ -192,6 +195,10 @@ typedef struct swap_group
     int  fluxfromAtoB[eChanNR];  /**< Net flux of ions per channel                          */
     int  nCyl[eChanNR];          /**< Number of ions residing in a channel                  */
     int  nCylBoth = 0;           /**< Ions assigned to cyl0 and cyl1. Not good.             */
+    std::vector<unsigned char> molInComp; /**< Per molecule, bit c is set if the molecule
+                                               is in compartment c (size nMol)               */
+    std::vector<std::array<real, eCompNR>> molDistToBulk; /**< Distance of each molecule to the
+                                                              bulk layers (size nMol)        */
 } t_swapgrp;
 
 t_swapgrp::swap_group(const gmx::LocalAtomSet& atomset) : atomset{ atomset }
@@ -681,6 +688,9 @@ static void detect_flux_per_channel(t_swapgrp*     g,
 }
 
 
+/*! \brief Minimum number of molecules per OpenMP thread when sorting molecules into compartments */
+static const int c_swapMinNumMoleculesPerThread = 1000;
+
 /*! \brief Determines which ions or solvent molecules are in compartment A and B */
 static void sortMoleculesIntoCompartments(t_swapgrp*    g,
                                           t_commrec*    cr,
@@ -695,34 +705,54 @@ static void sortMoleculesIntoCompartments(t_swapgrp*    g,
     int  nMolNotInComp[eCompNR]; /* consistency check */
     real cyl0_r2 = sc->cyl0r * sc->cyl0r;
     real cyl1_r2 = sc->cyl1r * sc->cyl1r;
+    real left[eCompNR], right[eCompNR];
+    int  sd = s->swapdim;
 
     /* Get us a counter that cycles in the range of [0 ... sc->nAverage[ */
     int replace = (step / sc->nstswap) % sc->nAverage;
 
     for (int comp = eCompA; comp <= eCompB; comp++)
     {
-        real left, right;
+        get_compartment_boundaries(comp, s, box, &left[comp], &right[comp]);
+    }
 
-        /* Get lists of atoms that match criteria for this compartment */
-        get_compartment_boundaries(comp, s, box, &left, &right);
+    /* Check for all molecules in parallel whether their first atom is in each of
+     * the compartments, the lists are filled in molecule order afterwards */
+    const auto numMolecules = static_cast<int>(g->atomset.numAtomsGlobal() / g->apm);
+    g->molInComp.resize(numMolecules);
+    g->molDistToBulk.resize(numMolecules);
+    const int numThreads = std::clamp(numMolecules / c_swapMinNumMoleculesPerThread, 1,
+                                      std::max(1, gmx_omp_nthreads_get(emntDefault)));
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int iMol = 0; iMol < numMolecules; iMol++)
+    {
+        const int     iAtom     = iMol * g->apm;
+        unsigned char molInComp = 0;
+        for (int comp = eCompA; comp <= eCompB; comp++)
+        {
+            if (compartment_contains_atom(left[comp], right[comp], g->xc[iAtom][sd], box[sd][sd],
+                                          sc->bulkOffset[comp], &g->molDistToBulk[iMol][comp]))
+            {
+                molInComp |= (1 << comp);
+            }
+        }
+        g->molInComp[iMol] = molInComp;
+    }
 
+    for (int comp = eCompA; comp <= eCompB; comp++)
+    {
         /* First clear the ion molecule lists */
         g->comp[comp].nMol  = 0;
         nMolNotInComp[comp] = 0; /* consistency check */
 
         /* Loop over the molecules and atoms of this group */
-        for (int iMol = 0, iAtom = 0; iAtom < static_cast<int>(g->atomset.numAtomsGlobal());
-             iAtom += g->apm, iMol++)
+        for (int iMol = 0, iAtom = 0; iMol < numMolecules; iAtom += g->apm, iMol++)
         {
-            real dist;
-            int  sd = s->swapdim;
-
             /* Is this first atom of the molecule in the compartment that we look at? */
-            if (compartment_contains_atom(left, right, g->xc[iAtom][sd], box[sd][sd],
-                                          sc->bulkOffset[comp], &dist))
+            if (g->molInComp[iMol] & (1 << comp))
             {
                 /* Add the first atom of this molecule to the list of molecules in this compartment */
-                add_to_list(iAtom, &g->comp[comp], dist);
+                add_to_list(iAtom, &g->comp[comp], g->molDistToBulk[iMol][comp]);
 
                 /* Master also checks for ion groups through which channel each ion has passed */
                 if (MASTER(cr) && (g->comp_now != nullptr) && !bIsSolvent)
@@ -771,7 +801,6 @@ static void sortMoleculesIntoCompartments(t_swapgrp*    g,
     }
 
     /* Consistency checks */
-    const auto numMolecules = static_cast<int>(g->atomset.numAtomsGlobal() / g->apm);
     if (nMolNotInComp[eCompA] + nMolNotInComp[eCompB] != numMolecules)
     {
         fprintf(stderr,
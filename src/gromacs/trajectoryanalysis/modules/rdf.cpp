@@ -73,6 +73,7 @@
 #include "gromacs/trajectoryanalysis/analysissettings.h"
 #include "gromacs/trajectoryanalysis/topologyinformation.h"
 #include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/stringutil.h"
 
 namespace gmx
@@ -91,6 +92,12 @@ namespace
  * Actual analysis module
  */
 
+/*! \brief
+ * Maximum number of reference times test positions that are searched for
+ * pairs at once, limits the memory used for storing the pairs.
+ */
+const int c_maxPairsPerSearchBlock = 1 << 20;
+
 //! Normalization for the computed distribution.
 enum class Normalization : int
 {
@@ -466,6 +473,8 @@ public:
      * the RDF from these numbers.
      */
     std::vector<real> surfaceDist2_;
+    //! Pairs found for a block of test positions, without -surf.
+    std::vector<AnalysisNeighborhoodPair> pairs_;
 };
 
 TrajectoryAnalysisModuleDataPointer Rdf::startFrames(const AnalysisDataParallelOptions& opt,
@@ -569,18 +578,27 @@ void Rdf::analyzeFrame(int frnr, const t_trxframe& fr, t_pbc* pbc, TrajectoryAna
         else
         {
             // Standard neighborhood search over all pairs within the cutoff
-            // for the -surf no case.
-            AnalysisNeighborhoodPairSearch pairSearch = nbsearch.startPairSearch(sel[g]);
-            AnalysisNeighborhoodPair       pair;
-            while (pairSearch.findNextPair(&pair))
+            // for the -surf no case.  The pairs are searched with multiple
+            // threads for blocks of test positions, and histogrammed in the
+            // same order as a serial pair search returns them.
+            std::vector<AnalysisNeighborhoodPair>& pairs        = frameData.pairs_;
+            const int                              testPosCount = sel[g].posCount();
+            const int                              blockSize =
+                    std::max(1, c_maxPairsPerSearchBlock / std::max(1, refSel.posCount()));
+            for (int testBegin = 0; testBegin < testPosCount; testBegin += blockSize)
             {
-                const real r2 = pair.distance2();
-                if (r2 > cut2_)
+                const int testEnd = std::min(testBegin + blockSize, testPosCount);
+                nbsearch.findAllPairs(sel[g], testBegin, testEnd, gmx_omp_get_max_threads(), &pairs);
+                for (const AnalysisNeighborhoodPair& pair : pairs)
                 {
-                    // TODO: Consider whether the histogramming could be done with
-                    // less overhead (after first measuring the overhead).
-                    dh.setPoint(0, std::sqrt(r2));
-                    dh.finishPointSet();
+                    const real r2 = pair.distance2();
+                    if (r2 > cut2_)
+                    {
+                        // TODO: Consider whether the histogramming could be done with
+                        // less overhead (after first measuring the overhead).
+                        dh.setPoint(0, std::sqrt(r2));
+                        dh.finishPointSet();
+                    }
                 }
             }
         }
@@ -43,12 +43,20 @@
 #include "gmxpre.h"
 
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/utility/stringutil.h"
+
 #include "testutils/cmdlinetest.h"
+#include "testutils/mpitest.h"
+#include "testutils/setenv.h"
+#include "testutils/simulationdatabase.h"
 
 #include "moduletest.h"
+#include "simulatorcomparison.h"
 
 namespace
 {
@@ -74,4 +82,123 @@ TEST_F(DomainDecompositionSpecialCasesTest, AnEmptyDomainWorks)
     ASSERT_EQ(0, runner_.callMdrun());
 }
 
+/*! \brief Runs \p simulationName with and without \p environmentVariable set and compares the results
+ *
+ * The results are only expected to agree within tolerances, as the forces
+ * can be reduced in a different order.
+ */
+void runAndCompareWithEnvironmentVariable(gmx::test::MdrunTestFixture* fixture,
+                                          const std::string&           simulationName,
+                                          const char*                  environmentVariable,
+                                          const std::vector<gmx::test::SimulationOptionTuple>& mdrunOptions)
+{
+    using namespace gmx::test;
+
+    const int numRanksAvailable = getNumberOfTestMpiRanks();
+    if (!isNumberOfPpRanksSupported(simulationName, numRanksAvailable))
+    {
+        fprintf(stdout,
+                "Test system '%s' cannot run with %d ranks.\n"
+                "The supported numbers are: %s\n",
+                simulationName.c_str(), numRanksAvailable,
+                reportNumbersOfPpRanksSupported(simulationName).c_str());
+        return;
+    }
+
+    SCOPED_TRACE(gmx::formatString("Comparing simulations of '%s' without and with %s set",
+                                   simulationName.c_str(), environmentVariable));
+
+    const auto mdpFieldValues = prepareMdpFieldValues(simulationName.c_str(), "md", "no", "no");
+
+    EnergyTermsToCompare energyTermsToCompare{ {
+            { interaction_function[F_EPOT].longname, relativeToleranceAsPrecisionDependentUlp(10.0, 100, 80) },
+            { interaction_function[F_EKIN].longname, relativeToleranceAsPrecisionDependentUlp(60.0, 100, 80) },
+            { interaction_function[F_PRES].longname,
+              relativeToleranceAsPrecisionDependentFloatingPoint(10.0, 0.01, 0.001) },
+    } };
+
+    const TrajectoryFrameMatchSettings trajectoryMatchSettings{ true,
+                                                                true,
+                                                                true,
+                                                                ComparisonConditions::MustCompare,
+                                                                ComparisonConditions::MustCompare,
+                                                                ComparisonConditions::MustCompare,
+                                                                MaxNumFrames::compareAllFrames() };
+    TrajectoryTolerances trajectoryTolerances = TrajectoryComparison::s_defaultTrajectoryTolerances;
+    trajectoryTolerances.velocities           = trajectoryTolerances.coordinates;
+    const TrajectoryComparison trajectoryComparison{ trajectoryMatchSettings, trajectoryTolerances };
+
+    TestFileManager& fileManager = fixture->fileManager_;
+    SimulationRunner& runner     = fixture->runner_;
+
+    const auto referenceTrajectoryFileName = fileManager.getTemporaryFilePath("reference.trr");
+    const auto referenceEdrFileName        = fileManager.getTemporaryFilePath("reference.edr");
+    const auto testTrajectoryFileName      = fileManager.getTemporaryFilePath("test.trr");
+    const auto testEdrFileName             = fileManager.getTemporaryFilePath("test.edr");
+
+    runner.tprFileName_ = fileManager.getTemporaryFilePath("sim.tpr");
+    runner.useTopGroAndNdxFromDatabase(simulationName);
+    runner.useStringAsMdpFile(prepareMdpFileContents(mdpFieldValues));
+    runGrompp(&runner);
+
+    const char* environmentVariableBackup    = getenv(environmentVariable);
+    const int   overWriteEnvironmentVariable = 1;
+
+    gmxUnsetenv(environmentVariable);
+    runner.fullPrecisionTrajectoryFileName_ = referenceTrajectoryFileName;
+    runner.edrFileName_                     = referenceEdrFileName;
+    runMdrun(&runner, mdrunOptions);
+
+    gmxSetenv(environmentVariable, "1", overWriteEnvironmentVariable);
+    runner.fullPrecisionTrajectoryFileName_ = testTrajectoryFileName;
+    runner.edrFileName_                     = testEdrFileName;
+    runMdrun(&runner, mdrunOptions);
+
+    if (environmentVariableBackup != nullptr)
+    {
+        gmxSetenv(environmentVariable, environmentVariableBackup, overWriteEnvironmentVariable);
+    }
+    else
+    {
+        gmxUnsetenv(environmentVariable);
+    }
+
+    compareEnergies(referenceEdrFileName, testEdrFileName, energyTermsToCompare);
+    compareTrajectories(referenceTrajectoryFileName, testTrajectoryFileName, trajectoryComparison);
+}
+
+/*! \brief Checks that the single-round direct halo exchange reproduces the pulse halo exchange
+ *
+ * The non-bonded interactions are computed on the CPU, so the direct
+ * halo exchange is overlapped with the local non-bonded and PME work.
+ */
+TEST_F(DomainDecompositionSpecialCasesTest, DirectHaloExchangeMatchesPulses)
+{
+    // This system has interactions between atoms in different domains with 2 ranks
+    runAndCompareWithEnvironmentVariable(this, "tip3p5", "GMX_DD_DIRECT_HALO", { { "-nb", "cpu" } });
+}
+
+/*! \brief Checks that incremental local topology updates reproduce full updates
+ *
+ * The system is repartitioned every 8 steps. The kept bonded interactions
+ * are computed in a different order, so the results are only expected
+ * to agree within tolerances.
+ */
+TEST_F(DomainDecompositionSpecialCasesTest, IncrementalLocalTopologyMatchesFullUpdate)
+{
+    runAndCompareWithEnvironmentVariable(this, "glycine_no_constraints_vacuo",
+                                         "GMX_DD_INCREMENTAL_TOPOLOGY", {});
+}
+
+/*! \brief Checks that atom-weighted static cell sizes reproduce a uniform grid
+ *
+ * Dynamic load balancing is disabled, as the atom-weighted cell sizes
+ * are only used with static cells.
+ */
+TEST_F(DomainDecompositionSpecialCasesTest, AtomWeightedGridMatchesUniformGrid)
+{
+    runAndCompareWithEnvironmentVariable(this, "spc216", "GMX_DD_ATOM_WEIGHTED_GRID",
+                                         { { "-dlb", "no" } });
+}
+
 } // namespace